@@ -0,0 +1,47 @@
+#include "./arena.h"
+
+namespace
+{
+
+thread_local std::pmr::memory_resource* resource_current = std::pmr::new_delete_resource();
+
+} // namespace
+
+namespace qyzk::ohno
+{
+
+arena::arena(std::size_t const size_initial)
+    : m_buffer_initial(size_initial)
+    , m_resource(m_buffer_initial.data(), m_buffer_initial.size(), std::pmr::new_delete_resource())
+{
+}
+
+auto arena::get_resource(void) noexcept -> std::pmr::memory_resource&
+{
+    return m_resource;
+}
+
+auto arena::reset(void) noexcept -> void
+{
+    m_resource.release();
+}
+
+arena_scope::arena_scope(ohno::arena& arena) noexcept
+    : m_arena(arena)
+    , m_resource_previous(resource_current)
+{
+    resource_current = &m_arena.get_resource();
+}
+
+arena_scope::~arena_scope(void)
+{
+    resource_current = m_resource_previous;
+    m_arena.reset();
+}
+
+auto get_current_resource(void) noexcept -> std::pmr::memory_resource*
+{
+    return resource_current;
+}
+
+} // namespace qyzk::ohno
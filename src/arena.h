@@ -0,0 +1,106 @@
+#ifndef __QYZK_OHNO_ARENA_H__
+#define __QYZK_OHNO_ARENA_H__
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace qyzk::ohno
+{
+
+/*
+ * monotonic memory for everything parsed out of a single gateway frame
+ * the initial block is kept across resets, anything grown beyond it goes back to the heap
+ */
+class arena
+{
+public:
+    explicit arena(std::size_t const size_initial);
+
+    arena(arena const&) = delete;
+    auto operator=(arena const&) -> arena& = delete;
+
+    auto get_resource(void) noexcept -> std::pmr::memory_resource&;
+    auto reset(void) noexcept -> void;
+
+private:
+    std::vector< std::byte > m_buffer_initial;
+    std::pmr::monotonic_buffer_resource m_resource;
+}; // class qyzk::ohno::arena
+
+/*
+ * makes an arena the one arena_allocator draws from on this thread, resets it on exit
+ * nothing allocated inside the scope may outlive it
+ */
+class arena_scope
+{
+public:
+    explicit arena_scope(ohno::arena& arena) noexcept;
+    ~arena_scope(void);
+
+    arena_scope(arena_scope const&) = delete;
+    auto operator=(arena_scope const&) -> arena_scope& = delete;
+
+private:
+    ohno::arena& m_arena;
+    std::pmr::memory_resource* m_resource_previous;
+}; // class qyzk::ohno::arena_scope
+
+// the arena in scope on this thread, or the heap when there is none
+auto get_current_resource(void) noexcept -> std::pmr::memory_resource*;
+
+/*
+ * constructs an object in the current arena that is never destroyed, it goes away with the arena's memory
+ * only for types whose allocations all come from the arena as well
+ */
+template <typename type, typename... argument_types>
+auto construct_in_arena(argument_types&&... arguments) -> type&
+{
+    auto* const memory = get_current_resource()->allocate(sizeof(type), alignof(type));
+    return *new (memory) type(std::forward< argument_types >(arguments)...);
+}
+
+/*
+ * stateless so that it can be default constructed where nlohmann::basic_json wants it
+ */
+template <typename type>
+class arena_allocator
+{
+public:
+    using value_type = type;
+
+    arena_allocator(void) noexcept = default;
+
+    template <typename other_type>
+    arena_allocator(arena_allocator< other_type > const&) noexcept
+    {
+    }
+
+    auto allocate(std::size_t const count) -> type*
+    {
+        return static_cast< type* >(get_current_resource()->allocate(count * sizeof(type), alignof(type)));
+    }
+
+    auto deallocate(type* const pointer, std::size_t const count) noexcept -> void
+    {
+        get_current_resource()->deallocate(pointer, count * sizeof(type), alignof(type));
+    }
+
+    template <typename other_type>
+    auto operator==(arena_allocator< other_type > const&) const noexcept -> bool
+    {
+        return true;
+    }
+
+    template <typename other_type>
+    auto operator!=(arena_allocator< other_type > const&) const noexcept -> bool
+    {
+        return false;
+    }
+}; // class qyzk::ohno::arena_allocator
+
+} // namespace qyzk::ohno
+
+#endif
@@ -0,0 +1,41 @@
+#include <algorithm>
+
+#include "./backoff.h"
+
+namespace qyzk::ohno
+{
+
+backoff::backoff(
+    duration_type const base,
+    duration_type const cap)
+    : m_base(base)
+    , m_cap(cap)
+    , m_delay_last(duration_type::zero())
+    , m_attempts(0)
+    , m_random(std::random_device()())
+{
+}
+
+auto backoff::next(void) -> duration_type
+{
+    auto const low = m_attempts == 0 ? duration_type::zero() : m_base;
+    auto const high = std::max(m_base, m_delay_last * 3);
+    std::uniform_int_distribution< duration_type::rep > distribution(low.count(), high.count());
+
+    m_delay_last = std::min(m_cap, duration_type(distribution(m_random)));
+    ++m_attempts;
+    return m_delay_last;
+}
+
+auto backoff::reset(void) noexcept -> void
+{
+    m_delay_last = duration_type::zero();
+    m_attempts = 0;
+}
+
+auto backoff::get_attempts(void) const noexcept -> uint32_t
+{
+    return m_attempts;
+}
+
+} // namespace qyzk::ohno
@@ -0,0 +1,37 @@
+#ifndef __QYZK_OHNO_BACKOFF_H__
+#define __QYZK_OHNO_BACKOFF_H__
+
+#include <chrono>
+#include <random>
+
+namespace qyzk::ohno
+{
+
+/*
+ * decorrelated jitter, every delay is drawn between the base and three times the previous one, up to a cap
+ * after a reset the first delay is drawn below the base, a healthy connection that drops comes back quickly
+ */
+class backoff
+{
+public:
+    using duration_type = std::chrono::milliseconds;
+
+    backoff(
+        duration_type const base,
+        duration_type const cap);
+
+    auto next(void) -> duration_type;
+    auto reset(void) noexcept -> void;
+    auto get_attempts(void) const noexcept -> uint32_t;
+
+private:
+    duration_type const m_base;
+    duration_type const m_cap;
+    duration_type m_delay_last;
+    uint32_t m_attempts;
+    std::mt19937 m_random;
+}; // class qyzk::ohno::backoff
+
+} // namespace qyzk::ohno
+
+#endif
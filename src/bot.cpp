@@ -1,4 +1,9 @@
+#include <algorithm>
+#include <array>
 #include <map>
+#include <sstream>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include <boost/bind.hpp>
@@ -6,6 +11,9 @@
 
 #include "./bot.h"
 #include "./command.h"
+#include "./decoder.h"
+#include "./envelope.h"
+#include "./intent.h"
 #include "./opcode.h"
 #include "./event.h"
 
@@ -15,11 +23,6 @@ using namespace boost::beast;
 namespace
 {
 
-auto generate_gateway_option(uint32_t const& version_gateway) -> std::string
-{
-    return "/?v=" + std::to_string(version_gateway) + "&encoding=json";
-}
-
 using key = std::decay_t< qyzk::ohno::config::cache_type >::key_type;
 
 auto get_sequence(qyzk::ohno::config const& config) -> uint32_t
@@ -31,9 +34,154 @@ auto get_sequence(qyzk::ohno::config const& config) -> uint32_t
         return cache.get< key::last_event_sequence >();
 }
 
-auto is_dohyeon(std::string const& id) -> bool
+// kept with the session, so that a restarted bot resumes where the gateway said to
+auto set_resume_gateway_url(
+    qyzk::ohno::config::cache_type& cache,
+    std::string_view const url)
+    -> void
 {
-    return id == "305519394656878595"; // yeeees
+    if (url.empty())
+        cache.reset< key::resume_gateway_url >();
+    else
+        cache.set< key::resume_gateway_url >(std::string(url));
+}
+
+// big enough for everything but guild creates and ready
+constexpr std::size_t arena_size_initial = 256 * 1024;
+
+// idle receive buffers kept per size class, and how many frames the pool's high-water mark looks back on
+constexpr std::size_t buffers_per_class = 4;
+constexpr std::size_t frames_per_window = 256;
+
+// pieces read off the socket at once, and the frame size from which the pieces are parsed right away
+constexpr std::size_t size_read_chunk = 64 * 1024;
+constexpr std::size_t size_stream_threshold = 256 * 1024;
+
+// how often a held back dispatch is retried while the queue is full
+constexpr auto interval_retry_dispatch = std::chrono::milliseconds(1);
+
+// how long to wait before identifying again after an invalid session, the gateway asks for a random pick
+constexpr int64_t delay_identify_min = 1000;
+constexpr int64_t delay_identify_max = 5000;
+
+// reconnect delays, see qyzk::ohno::backoff
+constexpr auto delay_reconnect_base = std::chrono::seconds(1);
+constexpr auto delay_reconnect_cap = std::chrono::seconds(60);
+
+// what the gateway's close code leaves for the next connection to do
+enum class close_action_type
+{
+    resume,
+    identify, // the session is gone
+    stop, // reconnecting would be refused the same way
+};
+
+auto get_close_action(uint16_t const code) noexcept -> close_action_type
+{
+    switch (code)
+    {
+    case 4004: // authentication failed
+    case 4010: // invalid shard
+    case 4011: // sharding required
+    case 4012: // invalid api version
+    case 4013: // invalid intents
+    case 4014: // disallowed intents
+        return close_action_type::stop;
+
+    case 4003: // not authenticated
+    case 4005: // already authenticated
+    case 4007: // invalid sequence
+    case 4009: // session timed out
+        return close_action_type::identify;
+
+    default:
+        return close_action_type::resume;
+    }
+}
+
+auto buffer_view(qyzk::ohno::bot::buffer_type const& buffer) -> std::string_view
+{
+    // flat_buffer keeps its readable bytes contiguous, so the frame can be
+    // parsed in place instead of being copied out into a string first
+    auto const data = buffer.data();
+    return { static_cast< char const* >(data.data()), data.size() };
+}
+
+// events with a case in bot::handle_event_dispatch or bot::handle_dispatch_job, everything else is never parsed
+constexpr std::array handled_events {
+    qyzk::ohno::event_type::ready,
+    qyzk::ohno::event_type::resumed,
+    qyzk::ohno::event_type::message_create,
+};
+
+// events keeping the guild cache current, subscribed to only when it's on
+constexpr std::array guild_cache_events {
+    qyzk::ohno::event_type::guild_create,
+    qyzk::ohno::event_type::guild_delete,
+    qyzk::ohno::event_type::channel_create,
+    qyzk::ohno::event_type::channel_update,
+    qyzk::ohno::event_type::channel_delete,
+    qyzk::ohno::event_type::guild_role_create,
+    qyzk::ohno::event_type::guild_role_update,
+    qyzk::ohno::event_type::guild_role_delete,
+};
+
+// member events take the privileged members intent, which is never asked for, but are cached when it's set explicitly
+constexpr std::array guild_cache_member_events {
+    qyzk::ohno::event_type::guild_member_add,
+    qyzk::ohno::event_type::guild_member_update,
+    qyzk::ohno::event_type::guild_member_remove,
+};
+
+// frames are read in pieces and big ones parsed while they arrive, only json can be parsed that way
+auto is_streaming(qyzk::ohno::config const& config) -> bool
+{
+    return config.get_gateway_streaming() && config.get_gateway_encoding() == qyzk::ohno::encoding_type::json;
+}
+
+// guild creates go into the guild cache through the frame stream, so the cache needs streaming
+auto is_caching_guilds(qyzk::ohno::config const& config) -> bool
+{
+    return is_streaming(config) && config.get_gateway_cache_guilds();
+}
+
+auto is_handled(
+    qyzk::ohno::event_type const event,
+    qyzk::ohno::config const& config)
+    -> bool
+{
+    if (std::find(guild_cache_events.begin(), guild_cache_events.end(), event) != guild_cache_events.end()
+        || std::find(guild_cache_member_events.begin(), guild_cache_member_events.end(), event) != guild_cache_member_events.end())
+    {
+        return is_caching_guilds(config);
+    }
+    return std::find(handled_events.begin(), handled_events.end(), event) != handled_events.end();
+}
+
+auto get_identify_option(qyzk::ohno::config const& config) -> qyzk::ohno::identify_option
+{
+    using qyzk::ohno::intent_type;
+
+    // handle_message_create reads the message text, which sits behind its own intent
+    uint32_t intents = static_cast< uint32_t >(intent_type::message_content);
+    for (auto const event : handled_events)
+        intents |= qyzk::ohno::get_intents(event);
+    if (is_caching_guilds(config))
+    {
+        for (auto const event : guild_cache_events)
+            intents |= qyzk::ohno::get_intents(event);
+    }
+
+    return {
+        config.get_gateway_intents().value_or(intents),
+        config.get_large_threshold(),
+        config.get_guild_subscriptions(),
+    };
+}
+
+auto is_dohyeon(qyzk::ohno::snowflake_type const id) -> bool
+{
+    return id == 305519394656878595; // yeeees
 }
 
 } // namespace
@@ -47,142 +195,505 @@ bot::bot(
     std::filesystem::path const& path_config,
     boost::asio::io_context& context_io,
     boost::asio::ssl::context& context_ssl,
+    ohno::resolver_cache& resolver,
     ohno::config& config,
-    get_gateway_bot_result const& material_bot)
+    std::string const& url_gateway)
     : m_path_config(path_config)
     , m_config(config)
-    , m_hosts_http(resolve(config.get_discord_hostname(), "https"))
+    , m_resolver(resolver)
     , m_context_io(context_io)
+    , m_strand(boost::asio::make_strand(context_io))
     , m_context_ssl(context_ssl)
-    , m_buffer_event()
-    , m_stream_gateway(
-        connect_to_gateway(
-            m_context_io,
-            m_context_ssl,
-            material_bot.url,
-            generate_gateway_option(m_config.get_gateway_version())))
+    , m_client_rest(context_io, config, context_ssl, resolver)
+    , m_url_gateway(url_gateway)
+    , m_pool_buffer(buffers_per_class, frames_per_window)
+    , m_counters_writer()
+    , m_connection()
+    , m_count_connection(0)
+    , m_is_connecting(false)
+    , m_timer_reconnect(m_context_io)
+    , m_backoff(delay_reconnect_base, delay_reconnect_cap)
+    , m_decoder(make_decoder(m_config))
+    , m_arena(arena_size_initial)
     , m_timer_heartbeat(m_context_io)
+    , m_tracker_heartbeat()
     , m_status_connection(connection_status_type::connecting)
     , m_is_running(true)
-    , m_timer_ko3()
+    , m_cache_guild()
+    , m_timer_ko3(ko3_timer_type())
+    , m_timer_backpressure(m_context_io)
+    , m_timers_delayed()
+    , m_random(std::random_device()())
+    , m_job_pending()
+    , m_dispatcher(
+        m_config,
+        [this](dispatch_job const& job, ohno::decoder& decoder)
+        {
+            handle_dispatch_job(job, decoder);
+        })
 {
+    if (m_config.get_gateway_streaming() && !is_streaming(m_config))
+        BOOST_LOG_TRIVIAL(warning) << "streaming only works with json encoding, reading frames whole";
+    if (m_config.get_gateway_cache_guilds() && !is_caching_guilds(m_config))
+        BOOST_LOG_TRIVIAL(warning) << "the guild cache is filled from streamed frames, leaving it off";
 }
 
-auto bot::async_listen_event(void) -> void
+auto bot::start(void) -> void
 {
-    m_stream_gateway.async_read(
-        m_buffer_event,
-        boost::bind(
-            &bot::handle_event,
-            this,
-            boost::asio::placeholders::error,
-            boost::asio::placeholders::bytes_transferred));
+    boost::asio::dispatch(
+        m_strand,
+        [this](void)
+        {
+            connect();
+        });
 }
 
 auto bot::stop(void) -> void
+{
+    // called from outside the bot's strand, e.g. by the signal handler
+    boost::asio::dispatch(
+        m_strand,
+        [this](void)
+        {
+            close();
+        });
+}
+
+auto bot::close(void) -> void
 {
     m_is_running = false;
     m_timer_heartbeat.cancel();
+    m_timer_backpressure.cancel();
+    m_timer_reconnect.cancel();
+    for (auto& timer : m_timers_delayed)
+        timer.cancel();
+    m_client_rest.close();
+    m_resolver.close();
+    log_heartbeat_statistics();
+    log_writer_statistics();
+    log_buffer_statistics();
+    log_rest_statistics();
+    save_config(m_path_config, m_config);
+
+    // a connection still being made is dropped once it's there
+    if (!m_connection)
+        return;
+
+    // queued behind whatever is still being written, the pending read ends once the close is through
+    m_connection->writer.close(
+        websocket::close_code::going_away,
+        [](error_code const& error)
+        {
+            if (!error)
+                return;
+
+            if (error == boost::asio::ssl::error::stream_truncated)
+            {
+                BOOST_LOG_TRIVIAL(debug) << "server has closed connection";
+            }
+            else
+            {
+                BOOST_LOG_TRIVIAL(error) << "oh no fatal error on closing connection: " << error.message();
+            }
+        });
+}
+
+auto bot::connect(void) -> void
+{
+    // a session is resumed where the gateway said to, a new one starts at the url we were given
+    auto const& cache = m_config.get_cache();
+    auto const is_resuming = cache.has< key::session_id >() && cache.has< key::resume_gateway_url >();
+    auto const url = is_resuming ? cache.get< key::resume_gateway_url >() : m_url_gateway;
+
+    BOOST_LOG_TRIVIAL(debug) << "connecting to gateway " << url;
+    m_is_connecting = true;
+    async_connect_to_gateway(
+        m_strand,
+        m_context_ssl,
+        m_resolver,
+        url,
+        "/" + m_config.get_gateway_option(),
+        [this](error_code const& error, std::unique_ptr< ws_stream_type > stream)
+        {
+            handle_connect(error, std::move(stream));
+        });
+}
+
+auto bot::handle_connect(
+    error_code const& error,
+    std::unique_ptr< ws_stream_type > stream)
+    -> void
+{
+    m_is_connecting = false;
+    if (!m_is_running)
+    {
+        BOOST_LOG_TRIVIAL(debug) << "bot has stopped while connecting, dropping connection";
+        return;
+    }
 
-    error_code error;
-    m_stream_gateway.close(websocket::close_code::going_away, error);
     if (error)
     {
-        if (error == boost::asio::ssl::error::stream_truncated)
-        {
-            BOOST_LOG_TRIVIAL(debug) << "server has closed connection";
-        }
-        else
+        async_reconnect();
+        return;
+    }
+
+    // the connection the gateway asked to leave is only dropped now, nothing was lost waiting for this one
+    if (m_connection)
+    {
+        BOOST_LOG_TRIVIAL(debug) << "connection " << (m_count_connection + 1) << " takes over from connection " << m_connection->id;
+        retire_connection();
+    }
+
+    // etf payloads are binary, the gateway rejects them in text frames
+    stream->binary(m_config.get_gateway_encoding() == encoding_type::etf);
+    m_connection = make_gateway_connection(++m_count_connection, std::move(stream), m_strand, m_pool_buffer, m_counters_writer);
+    BOOST_LOG_TRIVIAL(debug) << "connected to gateway, connection " << m_connection->id;
+
+    // a held back dispatch resumes reading once it's through
+    if (!m_job_pending)
+        async_listen_event();
+}
+
+auto bot::retire_connection(void) -> void
+{
+    if (!m_connection)
+        return;
+
+    // no close handshake, the other end may not answer it and a session closed abnormally stays resumable
+    // whatever is pending on the connection fails and lets go of it
+    BOOST_LOG_TRIVIAL(debug) << "retiring connection " << m_connection->id;
+    log_heartbeat_statistics();
+    log_writer_statistics();
+    log_buffer_statistics();
+    // resuming on the next connection or after a restart picks up from the last sequence seen
+    save_config(m_path_config, m_config);
+    m_timer_heartbeat.cancel();
+    m_connection->writer.cancel();
+    boost::beast::get_lowest_layer(*m_connection->stream).close();
+    m_connection.reset();
+}
+
+auto bot::handle_reconnect(void) -> void
+{
+    // the old connection is still read from while the new one is being made, the gateway hangs up on it soon anyway
+    BOOST_LOG_TRIVIAL(debug) << "gateway asked for a reconnect, connecting alongside connection " << m_connection->id;
+    if (!m_is_connecting)
+        connect();
+}
+
+auto bot::async_reconnect(void) -> void
+{
+    // the connection already being made takes over
+    if (m_is_connecting)
+        return;
+
+    auto const delay = m_backoff.next();
+    BOOST_LOG_TRIVIAL(warning)
+        << "reconnecting to gateway in " << delay.count() << "ms, attempt " << m_backoff.get_attempts();
+    m_timer_reconnect.expires_after(delay);
+    m_timer_reconnect.async_wait(
+        boost::asio::bind_executor(
+            m_strand,
+            boost::bind(
+                &bot::reconnect,
+                this,
+                placeholders::error)));
+}
+
+auto bot::reconnect(error_code const& error) -> void
+{
+    if (error)
+    {
+        if (error != boost::asio::error::operation_aborted)
+            BOOST_LOG_TRIVIAL(error) << "error occured during reconnect timer operation: " << error.message();
+        return;
+    }
+
+    if (m_is_running)
+        connect();
+}
+
+auto bot::async_listen_event(void) -> void
+{
+    // nothing to read from until the next connection is there
+    if (!m_connection)
+        return;
+
+    auto& connection = *m_connection;
+    if (is_streaming(m_config))
+    {
+        connection.stream->async_read_some(
+            *connection.buffer_event,
+            size_read_chunk,
+            boost::asio::bind_executor(
+                m_strand,
+                boost::bind(
+                    &bot::handle_event_chunk,
+                    this,
+                    m_connection,
+                    boost::asio::placeholders::error)));
+        return;
+    }
+
+    connection.stream->async_read(
+        *connection.buffer_event,
+        boost::asio::bind_executor(
+            m_strand,
+            boost::bind(
+                &bot::handle_event,
+                this,
+                m_connection,
+                boost::asio::placeholders::error)));
+}
+
+auto bot::handle_event(
+    connection_type const& connection,
+    error_code const& error)
+    -> void
+{
+    if (connection != m_connection)
+    {
+        BOOST_LOG_TRIVIAL(debug) << "read on retired connection " << connection->id << " has ended";
+        return;
+    }
+
+    if (error)
+    {
+        handle_read_error(error);
+        return;
+    }
+
+    auto* buffer_frame = &connection->buffer_event;
+    if (m_config.get_gateway_compression() == compression_type::zlib_stream)
+    {
+        auto const is_complete = connection->inflater.feed(buffer_view(*connection->buffer_event), *connection->buffer_inflated);
+        connection->buffer_event->clear();
+        if (!is_complete)
         {
-            BOOST_LOG_TRIVIAL(error) << "oh no fatal error on closing connection: " << error.message();
+            if (m_is_running)
+                async_listen_event();
+            return;
         }
+
+        // the payload may have come in several messages, all of them count
+        auto const size_compressed = connection->inflater.get_compressed_size();
+        auto const size_payload = size_compressed - std::exchange(connection->size_compressed_done, size_compressed);
+        buffer_frame = &connection->buffer_inflated;
+        BOOST_LOG_TRIVIAL(debug)
+            << "inflated " << size_payload << " bytes into " << connection->buffer_inflated->size()
+            << " bytes, compression ratio: " << connection->inflater.get_compression_ratio();
     }
+
+    handle_frame(*buffer_frame);
 }
 
-auto bot::handle_event(
-    error_code const& error,
-    std::size_t const bytes_written)
+auto bot::handle_event_chunk(
+    connection_type const& connection,
+    error_code const& error)
     -> void
 {
+    if (connection != m_connection)
+    {
+        BOOST_LOG_TRIVIAL(debug) << "read on retired connection " << connection->id << " has ended";
+        return;
+    }
+
     if (error)
     {
-        if (m_is_running)
+        handle_read_error(error);
+        return;
+    }
+
+    auto* buffer_frame = &connection->buffer_event;
+    auto is_complete = true;
+    if (m_config.get_gateway_compression() == compression_type::zlib_stream)
+    {
+        // inflated as it goes, a payload may span several messages and only its last one ends with the suffix
+        is_complete = connection->inflater.feed(buffer_view(*connection->buffer_event), *connection->buffer_inflated);
+        connection->buffer_event->clear();
+        buffer_frame = &connection->buffer_inflated;
+    }
+
+    auto& stream_frame = connection->stream_frame;
+    auto const is_done = connection->stream->is_message_done() && is_complete;
+    if (!stream_frame && !is_done && (*buffer_frame)->size() >= size_stream_threshold)
+    {
+        BOOST_LOG_TRIVIAL(debug) << "frame is over " << size_stream_threshold << " bytes, parsing it as it arrives";
+        stream_frame.emplace(is_caching_guilds(m_config) ? &m_cache_guild : nullptr);
+        connection->size_streamed = 0;
+    }
+
+    if (stream_frame && stream_frame->get_status() != frame_stream_status::declined)
+    {
+        auto const text = buffer_view(**buffer_frame).substr(connection->size_streamed);
+        stream_frame->feed(text);
+        connection->size_streamed += text.size();
+
+        // until the event is known to be streamed the bytes are kept, a declined frame is read whole after all
+        if (stream_frame->get_status() == frame_stream_status::streaming)
         {
-            BOOST_LOG_TRIVIAL(error) << "oh no unexpected connection error: " << error.message();
-            m_is_running = false;
-            m_context_io.stop();
+            (*buffer_frame)->consume(connection->size_streamed);
+            connection->size_streamed = 0;
         }
-        else if (error == boost::asio::error::operation_aborted)
+    }
+
+    if (!is_done)
+    {
+        if (m_is_running)
+            async_listen_event();
+        return;
+    }
+
+    if (stream_frame)
+    {
+        if (stream_frame->get_status() != frame_stream_status::declined)
+            stream_frame->finish();
+
+        if (stream_frame->get_status() == frame_stream_status::streaming)
         {
-            BOOST_LOG_TRIVIAL(debug) << "listening event operation has been aborted";
+            handle_frame_stream(*stream_frame);
+            stream_frame.reset();
+            (*buffer_frame)->clear();
+            if (m_is_running)
+                async_listen_event();
+            return;
         }
+        stream_frame.reset();
+    }
+
+    handle_frame(*buffer_frame);
+}
+
+auto bot::handle_read_error(error_code const& error) -> void
+{
+    if (!m_is_running)
+    {
+        if (error == boost::asio::error::operation_aborted)
+            BOOST_LOG_TRIVIAL(debug) << "listening event operation has been aborted";
         else
-        {
             BOOST_LOG_TRIVIAL(error) << "error occured while closing connection maybe?: " << error.message();
-        }
         return;
     }
 
-    auto buffer_string = buffers_to_string(m_buffer_event.data());
-    m_buffer_event.clear();
-    BOOST_LOG_TRIVIAL(debug) << "read event: " << buffer_string;
+    // only a close frame from the gateway comes with a code, a dropped connection is resumed
+    uint16_t code = 0;
+    if (error == websocket::error::closed)
+        code = m_connection->stream->reason().code;
+    BOOST_LOG_TRIVIAL(error) << "oh no gateway connection lost: " << error.message() << ", close code: " << code;
+
+    switch (get_close_action(code))
+    {
+    case close_action_type::stop:
+        BOOST_LOG_TRIVIAL(error) << "gateway won't take this bot as it is, stopping";
+        m_is_running = false;
+        m_timer_backpressure.cancel();
+        retire_connection();
+        // nothing else the process is here for
+        m_context_io.stop();
+        return;
+
+    case close_action_type::identify:
+        BOOST_LOG_TRIVIAL(debug) << "session can't be resumed, next connection starts a new one";
+        forget_session();
+        break;
+
+    case close_action_type::resume:
+        break;
+    }
+
+    retire_connection();
+    async_reconnect();
+}
+
+auto bot::handle_frame(pooled_buffer& buffer_frame) -> void
+{
+    // decoders may read a little past the frame, see frame_padding
+    buffer_frame->prepare(frame_padding);
+    auto const frame = buffer_view(*buffer_frame);
+    m_pool_buffer.record_frame(frame.size());
+    if (m_config.get_gateway_encoding() == encoding_type::json)
+        BOOST_LOG_TRIVIAL(debug) << "read event: " << frame;
+    else
+        BOOST_LOG_TRIVIAL(debug) << "read etf event of " << frame.size() << " bytes";
+
+    // payload trees built by dom decoders live in the arena and are freed at once when the scope ends
+    arena_scope const scope(m_arena);
 
-    auto payload = json::parse(buffer_string);
-    auto const opcode = static_cast< opcode_type >(payload["op"]);
-    auto const& opcode_name = opcode_names.find(opcode)->second;
+    auto const envelope = m_decoder->scan(frame);
+    auto const opcode_name = opcode_names.name(envelope.opcode);
     BOOST_LOG_TRIVIAL(debug) << "opcode: " << opcode_name;
 
     auto& cache = m_config.get_cache();
 
-    switch (opcode)
+    switch (envelope.opcode)
     {
     case opcode_type::dispatch:
-        handle_event_dispatch(payload);
+        handle_event_dispatch(envelope, buffer_frame);
         break;
 
     case opcode_type::heartbeat:
+        // asked for by the gateway, which is alive then, so this one is not tracked
         BOOST_LOG_TRIVIAL(debug) << "get heartbeat event";
-        ohno::heartbeat(m_stream_gateway, get_sequence(m_config));
+        ohno::heartbeat(m_connection->writer, get_sequence(m_config), m_config.get_gateway_encoding());
+        break;
+
+    case opcode_type::heartbeat_ack:
+        handle_heartbeat_ack();
         break;
 
     case opcode_type::hello:
         BOOST_LOG_TRIVIAL(debug) << "get hello event";
-        m_interval_heartbeat = payload["d"]["heartbeat_interval"];
+        m_interval_heartbeat = m_decoder->decode_hello(frame).heartbeat_interval;
         m_timer_heartbeat.expires_after(
             chrono::milliseconds(m_interval_heartbeat));
         m_timer_heartbeat.async_wait(
-            boost::bind(
-                &bot::heartbeat,
-                this,
-                placeholders::error));
-        ohno::heartbeat(m_stream_gateway, get_sequence(m_config));
+            boost::asio::bind_executor(
+                m_strand,
+                boost::bind(
+                    &bot::heartbeat,
+                    this,
+                    placeholders::error)));
+        m_tracker_heartbeat.reset();
+        send_heartbeat();
         if (cache.has< key::session_id >())
         {
             BOOST_LOG_TRIVIAL(debug) << "resuming previous session";
             resume(
-                m_stream_gateway,
+                m_connection->writer,
                 m_config.get_token(),
                 cache.get< key::session_id >(),
-                get_sequence(m_config));
+                get_sequence(m_config),
+                m_config.get_gateway_encoding());
             m_status_connection = connection_status_type::resuming;
         }
         else
         {
             BOOST_LOG_TRIVIAL(debug) << "starting new session";
-            ohno::identify(m_stream_gateway, m_config.get_token());
+            ohno::identify(m_connection->writer, m_config.get_token(), get_identify_option(m_config), m_config.get_gateway_encoding());
             m_status_connection = connection_status_type::connecting;
         }
         break;
 
     case opcode_type::invalid_session:
-        handle_invalid_session(payload);
+        handle_invalid_session(m_decoder->decode_invalid_session(frame));
+        break;
+
+    case opcode_type::reconnect:
+        handle_reconnect();
         break;
 
     default:
         BOOST_LOG_TRIVIAL(debug) << "skipped handling event " << opcode_name;
     }
 
-    if (m_is_running)
+    // a dispatched frame took its buffer along, any other goes back so the pool can drop it if it's oversized
+    buffer_frame.reset();
+    buffer_frame = m_pool_buffer.acquire();
+
+    // with the dispatch queue full the next read waits until the held back event fits
+    if (m_job_pending)
+        async_retry_dispatch();
+    else if (m_is_running)
         async_listen_event();
 }
 
@@ -192,10 +703,12 @@ auto bot::async_heartbeat() -> void
         m_timer_heartbeat.expiry()
         + chrono::milliseconds(m_interval_heartbeat));
     m_timer_heartbeat.async_wait(
-        boost::bind(
-            &bot::heartbeat,
-            this,
-            placeholders::error));
+        boost::asio::bind_executor(
+            m_strand,
+            boost::bind(
+                &bot::heartbeat,
+                this,
+                placeholders::error)));
 }
 
 auto bot::heartbeat(error_code const& error) -> void
@@ -209,103 +722,499 @@ auto bot::heartbeat(error_code const& error) -> void
         return;
     }
 
+    // fired just before its connection was retired
+    if (!m_connection)
+        return;
+
+    if (send_heartbeat() && m_is_running)
+        async_heartbeat();
+}
+
+auto bot::send_heartbeat(void) -> bool
+{
+    if (!m_tracker_heartbeat.try_send(heartbeat_tracker::clock_type::now()))
+    {
+        BOOST_LOG_TRIVIAL(warning) << "previous heartbeat was never acked, dropping zombie connection";
+        close_zombie();
+        return false;
+    }
+
     auto const sequence = get_sequence(m_config);
-    ohno::heartbeat(m_stream_gateway, sequence);
+    ohno::heartbeat(m_connection->writer, sequence, m_config.get_gateway_encoding());
     BOOST_LOG_TRIVIAL(debug) << "sent heartbeat ping, sequence: " << sequence;
+    return true;
+}
 
-    if (m_is_running)
-        async_heartbeat();
+auto bot::handle_heartbeat_ack(void) -> void
+{
+    auto const rtt = m_tracker_heartbeat.acknowledge(heartbeat_tracker::clock_type::now());
+    if (!rtt)
+    {
+        BOOST_LOG_TRIVIAL(debug) << "get heartbeat ack for an untracked heartbeat";
+        return;
+    }
+
+    auto const statistics = m_tracker_heartbeat.get_statistics();
+    BOOST_LOG_TRIVIAL(debug)
+        << "get heartbeat ack, rtt: " << rtt->count() << "ms (min " << statistics.rtt_min.count()
+        << "ms, max " << statistics.rtt_max.count() << "ms, missed " << statistics.count_missed << ")";
+}
+
+auto bot::close_zombie(void) -> void
+{
+    // resumes from the cached session straight away, only a failing connect backs off from there
+    retire_connection();
+    if (!m_is_connecting)
+        connect();
+}
+
+auto bot::get_heartbeat_statistics(void) const -> heartbeat_statistics
+{
+    return m_tracker_heartbeat.get_statistics();
+}
+
+auto bot::log_heartbeat_statistics(void) const -> void
+{
+    auto const statistics = get_heartbeat_statistics();
+    if (statistics.count_acked == 0)
+        return;
+
+    std::ostringstream histogram;
+    for (std::size_t index = 0; index < statistics.count_rtt.size(); ++index)
+    {
+        if (index < heartbeat_rtt_buckets.size())
+            histogram << " <=" << heartbeat_rtt_buckets[index] << "ms: ";
+        else
+            histogram << " slower: ";
+        histogram << statistics.count_rtt[index];
+    }
+
+    BOOST_LOG_TRIVIAL(info)
+        << "heartbeats: " << statistics.count_acked << " acked of " << statistics.count_sent << " sent, "
+        << statistics.count_missed << " missed, rtt avg " << (statistics.rtt_total / statistics.count_acked).count()
+        << "ms, min " << statistics.rtt_min.count() << "ms, max " << statistics.rtt_max.count() << "ms,"
+        << histogram.str();
+}
+
+auto bot::get_writer_statistics(void) const noexcept -> gateway_writer_statistics
+{
+    return {
+        m_counters_writer.count_written.load(),
+        m_counters_writer.count_waited.load(),
+        m_counters_writer.count_rejected.load(),
+    };
+}
+
+auto bot::log_writer_statistics(void) const -> void
+{
+    auto const statistics = get_writer_statistics();
+    if (statistics.count_written == 0 && statistics.count_rejected == 0)
+        return;
+
+    BOOST_LOG_TRIVIAL(info)
+        << "gateway writes: " << statistics.count_written << " written, "
+        << statistics.count_waited << " rate limit waits, " << statistics.count_rejected << " rejected";
+}
+
+auto bot::log_buffer_statistics(void) const -> void
+{
+    auto const statistics = m_pool_buffer.get_statistics();
+    if (statistics.count_allocated == 0)
+        return;
+
+    std::ostringstream histogram;
+    for (std::size_t index = 0; index < statistics.count_frames.size(); ++index)
+    {
+        if (index < buffer_size_classes.size())
+            histogram << " <=" << buffer_size_classes[index] / 1024 << "KiB: ";
+        else
+            histogram << " larger: ";
+        histogram << statistics.count_frames[index];
+    }
+
+    BOOST_LOG_TRIVIAL(info)
+        << "receive buffers: " << statistics.count_allocated << " allocated, " << statistics.count_reused << " reused, "
+        << statistics.count_dropped << " dropped, " << statistics.count_pooled << " pooled holding "
+        << statistics.size_pooled << " bytes, largest frame " << statistics.size_frame_max << " bytes, frames:"
+        << histogram.str();
+}
+
+auto bot::log_rest_statistics(void) const -> void
+{
+    auto const statistics = m_client_rest.get_statistics();
+    if (statistics.count_connected == 0)
+        return;
+
+    BOOST_LOG_TRIVIAL(info)
+        << "rest connections: " << statistics.count_connected << " connected, " << statistics.count_reused
+        << " reused, " << statistics.count_retried << " retried, " << statistics.count_timed_out << " timed out";
 }
 
-auto bot::handle_invalid_session(json const& payload) -> void
+auto bot::handle_invalid_session(invalid_session_event const& event) -> void
 {
     auto& cache = m_config.get_cache();
 
     switch (m_status_connection)
     {
     case connection_status_type::connecting:
+        // backing off on a fresh connection instead of giving up, the next identify may well get through
         BOOST_LOG_TRIVIAL(error) << "starting new session has rejected, maybe rate limited?";
-        m_is_running = false;
-        m_context_io.stop();
+        forget_session();
+        retire_connection();
+        async_reconnect();
         return;
 
     case connection_status_type::connected:
         BOOST_LOG_TRIVIAL(debug) << "current session has been invaliated";
-        if (static_cast< bool >(payload["d"]))
+        if (event.is_resumable)
         {
             BOOST_LOG_TRIVIAL(debug) << "resuming is availble, resuming session";
             m_status_connection = connection_status_type::resuming;
-            resume(m_stream_gateway, m_config.get_token(), cache.get< key::session_id >(), get_sequence(m_config));
+            resume(m_connection->writer, m_config.get_token(), cache.get< key::session_id >(), get_sequence(m_config), m_config.get_gateway_encoding());
         }
         else
         {
             BOOST_LOG_TRIVIAL(debug) << "resuming is unavailable, starting new session";
-            steady_timer timer(m_context_io);
-            timer.expires_after(chrono::seconds(2));
-            timer.wait();
-            m_status_connection = connection_status_type::connecting;
-            identify(m_stream_gateway, m_config.get_token());
+            identify_later();
         }
         break;
 
     case connection_status_type::resuming:
         BOOST_LOG_TRIVIAL(debug) << "resuming has been rejected, starting new session";
-        m_status_connection = connection_status_type::connecting;
-        identify(m_stream_gateway, m_config.get_token());
+        identify_later();
         break;
     }
 }
 
-auto bot::handle_event_dispatch(json const& payload) -> void
+auto bot::identify_later(void) -> void
+{
+    m_status_connection = connection_status_type::connecting;
+    forget_session();
+
+    std::uniform_int_distribution< int64_t > distribution(delay_identify_min, delay_identify_max);
+    auto const delay = chrono::milliseconds(distribution(m_random));
+    BOOST_LOG_TRIVIAL(debug) << "identifying in " << delay.count() << "ms";
+
+    // a reconnect in the meantime identifies by itself, the old connection is left alone
+    run_after(
+        delay,
+        [this, connection = m_connection](void)
+        {
+            if (connection != m_connection)
+                return;
+            identify(m_connection->writer, m_config.get_token(), get_identify_option(m_config), m_config.get_gateway_encoding());
+        });
+}
+
+auto bot::forget_session(void) -> void
 {
     auto& cache = m_config.get_cache();
-    cache.set< key::last_event_sequence >(payload["s"]);
+    cache.reset< key::session_id >();
+    cache.reset< key::resume_gateway_url >();
+    save_config(m_path_config, m_config);
+}
 
-    auto const event_name = payload["t"];
-    auto const event = events.find(event_name)->second;
-    auto const& data = payload["d"];
+auto bot::run_after(
+    chrono::milliseconds const delay,
+    task_type task)
+    -> void
+{
+    auto const timer = m_timers_delayed.emplace(m_timers_delayed.end(), m_context_io);
+    timer->expires_after(delay);
+    timer->async_wait(
+        boost::asio::bind_executor(
+            m_strand,
+            [this, timer, task = std::move(task)](error_code const& error)
+            {
+                m_timers_delayed.erase(timer);
+                if (error)
+                {
+                    if (error != boost::asio::error::operation_aborted)
+                        BOOST_LOG_TRIVIAL(error) << "error occured during delayed task timer operation: " << error.message();
+                    return;
+                }
+
+                if (m_is_running)
+                    task();
+            }));
+}
+
+auto bot::handle_event_dispatch(
+    ohno::envelope const& envelope,
+    pooled_buffer& buffer)
+    -> void
+{
+    auto& cache = m_config.get_cache();
+    if (envelope.sequence)
+        cache.set< key::last_event_sequence >(*envelope.sequence);
+
+    auto const& event_name = envelope.event_name;
+    auto const event = events.find(event_name);
+    if (!is_handled(event, m_config))
+    {
+        // the sequence is only kept in memory, it's written out with the next handled event or when the connection ends
+        BOOST_LOG_TRIVIAL(debug) << "skipping event " << event_name;
+        return;
+    }
 
+    // session events change connection state and guild cache events have to stay in order with the guild creates,
+    // both stay on the reader, the rest goes to the workers
     switch (event)
     {
     case event_type::ready:
+    {
         BOOST_LOG_TRIVIAL(debug) << "get ready event";
         m_status_connection = connection_status_type::connected;
-        cache.set< key::session_id >(data["session_id"]);
+        m_backoff.reset();
+        auto const ready = m_decoder->decode_ready(buffer_view(*buffer));
+        cache.set< key::session_id >(std::string(ready.session_id));
+        set_resume_gateway_url(cache, ready.resume_gateway_url);
         break;
+    }
 
     case event_type::resumed:
         BOOST_LOG_TRIVIAL(debug) << "get resumed event";
         m_status_connection = connection_status_type::connected;
+        m_backoff.reset();
         break;
 
-    case event_type::message_create:
-        BOOST_LOG_TRIVIAL(debug) << "get message create event";
-        handle_message_create(payload);
+    case event_type::guild_create:
+    {
+        // small enough to have been read whole, but goes into the guild cache the same way
+        ohno::frame_stream stream(&m_cache_guild);
+        stream.feed(buffer_view(*buffer));
+        stream.finish();
+        log_guild_create(stream);
+        break;
+    }
+
+    case event_type::guild_delete:
+    case event_type::channel_create:
+    case event_type::channel_update:
+    case event_type::channel_delete:
+    case event_type::guild_role_create:
+    case event_type::guild_role_update:
+    case event_type::guild_role_delete:
+    case event_type::guild_member_add:
+    case event_type::guild_member_update:
+    case event_type::guild_member_remove:
+        handle_guild_cache_event(event, buffer_view(*buffer));
         break;
 
     default:
-        BOOST_LOG_TRIVIAL(debug) << "skipping event " << event_name;
+        dispatch({ event, std::move(buffer) });
+    }
+
+    save_config(m_path_config, m_config);
+}
+
+auto bot::handle_guild_cache_event(
+    event_type const event,
+    std::string_view const frame)
+    -> void
+{
+    switch (event)
+    {
+    case event_type::guild_delete:
+    {
+        // an outage counts too, the guild comes back with a create of its own
+        auto const guild = m_decoder->decode_guild_delete(frame);
+        m_cache_guild.remove_guild(guild.id);
+        BOOST_LOG_TRIVIAL(debug) << "evicted guild " << guild.id << " from the guild cache";
+        break;
+    }
+
+    case event_type::channel_create:
+    case event_type::channel_update:
+    {
+        auto const channel = m_decoder->decode_channel(frame);
+        if (channel.guild_id)
+            m_cache_guild.set_channel(*channel.guild_id, { channel.id, std::string(channel.name) });
+        break;
+    }
+
+    case event_type::channel_delete:
+    {
+        auto const channel = m_decoder->decode_channel(frame);
+        if (!channel.guild_id)
+            break;
+
+        if (auto const cached = m_cache_guild.get_channel(*channel.guild_id, channel.id))
+            BOOST_LOG_TRIVIAL(debug) << "evicted channel #" << cached->name << " from the guild cache";
+        m_cache_guild.remove_channel(*channel.guild_id, channel.id);
+        break;
+    }
+
+    case event_type::guild_role_create:
+    case event_type::guild_role_update:
+    {
+        auto const role = m_decoder->decode_guild_role(frame);
+        m_cache_guild.set_role(role.guild_id, { role.role_id, std::string(role.name) });
+        break;
+    }
+
+    case event_type::guild_role_delete:
+    {
+        auto const role = m_decoder->decode_guild_role_delete(frame);
+        if (auto const cached = m_cache_guild.get_role(role.guild_id, role.role_id))
+            BOOST_LOG_TRIVIAL(debug) << "evicted role @" << cached->name << " from the guild cache";
+        m_cache_guild.remove_role(role.guild_id, role.role_id);
+        break;
+    }
+
+    case event_type::guild_member_add:
+    case event_type::guild_member_update:
+    {
+        auto const member = m_decoder->decode_guild_member(frame);
+        m_cache_guild.set_member(member.guild_id, { member.user_id, std::string(member.username) });
+        break;
+    }
+
+    case event_type::guild_member_remove:
+    {
+        auto const member = m_decoder->decode_guild_member(frame);
+        m_cache_guild.remove_member(member.guild_id, member.user_id);
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+auto bot::handle_frame_stream(frame_stream const& stream) -> void
+{
+    auto const envelope = stream.get_envelope();
+    m_pool_buffer.record_frame(stream.get_size());
+    BOOST_LOG_TRIVIAL(debug) << "streamed " << envelope.event_name << " event of " << stream.get_size() << " bytes";
+
+    auto& cache = m_config.get_cache();
+    if (envelope.sequence)
+        cache.set< key::last_event_sequence >(*envelope.sequence);
+
+    switch (stream.get_event())
+    {
+    case event_type::ready:
+        BOOST_LOG_TRIVIAL(debug) << "get ready event";
+        m_status_connection = connection_status_type::connected;
+        m_backoff.reset();
+        cache.set< key::session_id >(std::string(stream.get_session_id()));
+        set_resume_gateway_url(cache, stream.get_resume_gateway_url());
+        break;
+
+    case event_type::guild_create:
+        log_guild_create(stream);
+        break;
+
+    default:
+        break;
     }
 
     save_config(m_path_config, m_config);
 }
 
-auto bot::handle_message_create(json const& payload) -> void
+auto bot::log_guild_create(frame_stream const& stream) -> void
 {
-    auto const& data = payload["d"];
-    std::string const& id = data["author"]["id"];
-    std::string const& content = data["content"];
-    std::string const& channel = data["channel_id"];
+    // what the cache kept, members past its cap aren't counted
+    auto const counts = m_cache_guild.get_counts(stream.get_guild_id());
+    BOOST_LOG_TRIVIAL(debug)
+        << "cached guild " << stream.get_guild_id() << ": " << counts.channels << " channels, "
+        << counts.roles << " roles, " << counts.members << " members";
+}
+
+auto bot::dispatch(dispatch_job job) -> void
+{
+    if (!m_dispatcher.try_dispatch(job))
+    {
+        BOOST_LOG_TRIVIAL(warning) << "dispatch queue is full, holding back gateway reads";
+        m_job_pending = std::move(job);
+        return;
+    }
+
+    auto const statistics = m_dispatcher.get_statistics();
+    BOOST_LOG_TRIVIAL(debug)
+        << "dispatched " << events.name(job.event) << ", queue depth: " << statistics.depth
+        << " (max " << statistics.depth_max << ")";
+}
+
+auto bot::async_retry_dispatch(void) -> void
+{
+    m_timer_backpressure.expires_after(interval_retry_dispatch);
+    m_timer_backpressure.async_wait(
+        boost::asio::bind_executor(
+            m_strand,
+            boost::bind(
+                &bot::retry_dispatch,
+                this,
+                placeholders::error)));
+}
+
+auto bot::retry_dispatch(error_code const& error) -> void
+{
+    if (error)
+    {
+        if (error != boost::asio::error::operation_aborted)
+            BOOST_LOG_TRIVIAL(error) << "error occured during dispatch retry timer operation: " << error.message();
+        return;
+    }
+
+    if (!m_dispatcher.try_dispatch(*m_job_pending))
+    {
+        async_retry_dispatch();
+        return;
+    }
+
+    m_job_pending.reset();
+    if (m_is_running)
+        async_listen_event();
+}
+
+auto bot::handle_dispatch_job(
+    dispatch_job const& job,
+    ohno::decoder& decoder)
+    -> void
+{
+    auto const frame = buffer_view(*job.buffer);
+
+    switch (job.event)
+    {
+    case event_type::message_create:
+        BOOST_LOG_TRIVIAL(debug) << "get message create event";
+        handle_message_create(decoder.decode_message_create(frame));
+        break;
+
+    default:
+        BOOST_LOG_TRIVIAL(debug) << "skipping event " << events.name(job.event);
+    }
+}
+
+auto bot::handle_message_create(message_create_event const& event) -> void
+{
+    auto const id = event.author_id;
+    auto const content = event.content;
+    auto const channel = std::to_string(event.channel_id);
+
+    // names come from the guild cache when it's on, ids stand in for them otherwise
+    if (event.guild_id)
+    {
+        auto const cached_channel = m_cache_guild.get_channel(*event.guild_id, event.channel_id);
+        auto const cached_author = m_cache_guild.get_member(*event.guild_id, id);
+        BOOST_LOG_TRIVIAL(debug)
+            << "message from " << (cached_author ? cached_author->username : std::to_string(id))
+            << " in #" << (cached_channel ? cached_channel->name : channel);
+    }
 
-    if (is_dohyeon(id) && chrono::system_clock::now() - m_timer_ko3 >= chrono::minutes(5))
+    // handlers run on several workers at once, only one of them may claim the ko3 window
+    auto const now = chrono::system_clock::now();
+    auto last_ko3 = m_timer_ko3.load();
+    if (is_dohyeon(id) && now - last_ko3 >= chrono::minutes(5) && m_timer_ko3.compare_exchange_strong(last_ko3, now))
     {
-        m_timer_ko3 = chrono::system_clock::now();
-        send_message(m_config, m_hosts_http, channel, "으아아악 고3이다");
+        m_client_rest.send_message(channel, "으아아악 고3이다");
     }
 
-    else if (id == "257451263820562433" && content == "oh no")
+    else if (id == 257451263820562433 && content == "oh no")
     {
-        send_message(m_config, m_hosts_http, channel, "oh no");
+        m_client_rest.send_message(channel, "oh no");
     }
 }
 
@@ -1,8 +1,27 @@
 #ifndef __QYZK_OHNO_BOT_H__
 #define __QYZK_OHNO_BOT_H__
 
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <optional>
+#include <random>
+
+#include "./arena.h"
+#include "./backoff.h"
+#include "./buffer_pool.h"
 #include "./config.h"
+#include "./decoder.h"
+#include "./dispatcher.h"
+#include "./envelope.h"
+#include "./frame_stream.h"
+#include "./gateway_connection.h"
+#include "./gateway_writer.h"
+#include "./guild_cache.h"
+#include "./heartbeat_tracker.h"
 #include "./http_request.h"
+#include "./rest_client.h"
 
 namespace qyzk::ohno
 {
@@ -19,42 +38,123 @@ class bot
 public:
     using buffer_type = boost::beast::flat_buffer;
     using ko3_timer_type = std::chrono::time_point< std::chrono::system_clock >;
+    using strand_type = boost::asio::strand< boost::asio::io_context::executor_type >;
+    using task_type = std::function< void(void) >;
 
     bot(
         std::filesystem::path const& path_config,
         boost::asio::io_context& context_io,
         boost::asio::ssl::context& context_ssl,
+        ohno::resolver_cache& resolver,
         ohno::config& config,
-        get_gateway_bot_result const& material_bot);
+        std::string const& url_gateway);
 
-    auto async_listen_event(void) -> void;
+    // connects to the gateway and keeps reconnecting until stopped or the gateway refuses for good
+    auto start(void) -> void;
     auto stop(void) -> void;
+    // round trip times of heartbeats, for metrics, safe to call from any thread
+    auto get_heartbeat_statistics(void) const -> heartbeat_statistics;
+    // writes, rate limit waits and rejections on the gateway connection, safe to call from any thread
+    auto get_writer_statistics(void) const noexcept -> gateway_writer_statistics;
+    // runs task on the bot's strand after delay, unless the bot is stopped before, must be called on the strand
+    auto run_after(
+        std::chrono::milliseconds const delay,
+        task_type task)
+        -> void;
 
 private:
-    auto handle_event(
+    using connection_type = std::shared_ptr< gateway_connection >;
+
+    auto close(void) -> void;
+    auto connect(void) -> void;
+    auto handle_connect(
         boost::beast::error_code const& error,
-        std::size_t const bytes_written)
+        std::unique_ptr< ws_stream_type > stream)
+        -> void;
+    auto retire_connection(void) -> void;
+    auto handle_reconnect(void) -> void;
+    auto async_reconnect(void) -> void;
+    auto reconnect(
+        boost::beast::error_code const& error)
+        -> void;
+    auto async_listen_event(void) -> void;
+    auto handle_event(
+        connection_type const& connection,
+        boost::beast::error_code const& error)
+        -> void;
+    auto handle_event_chunk(
+        connection_type const& connection,
+        boost::beast::error_code const& error)
+        -> void;
+    auto handle_read_error(boost::beast::error_code const& error) -> void;
+    auto handle_frame(pooled_buffer& buffer_frame) -> void;
+    // keeps the guild cache current between guild creates, only subscribed to while it's on
+    auto handle_guild_cache_event(
+        event_type const event,
+        std::string_view const frame)
         -> void;
+    auto handle_frame_stream(frame_stream const& stream) -> void;
+    auto log_guild_create(frame_stream const& stream) -> void;
     auto async_heartbeat(void) -> void;
     auto heartbeat(
         boost::beast::error_code const& error)
         -> void;
-    auto handle_invalid_session(nlohmann::json const& payload) -> void;
-    auto handle_event_dispatch(nlohmann::json const& payload) -> void;
-    auto handle_message_create(nlohmann::json const& payload) -> void;
+    auto send_heartbeat(void) -> bool;
+    auto handle_heartbeat_ack(void) -> void;
+    auto close_zombie(void) -> void;
+    // totals since the bot started, logged whenever a connection ends
+    auto log_heartbeat_statistics(void) const -> void;
+    auto log_writer_statistics(void) const -> void;
+    auto log_buffer_statistics(void) const -> void;
+    // only on close, the rest client's connections don't end with the gateway's
+    auto log_rest_statistics(void) const -> void;
+    auto handle_invalid_session(invalid_session_event const& event) -> void;
+    auto identify_later(void) -> void;
+    auto forget_session(void) -> void;
+    auto handle_event_dispatch(
+        ohno::envelope const& envelope,
+        pooled_buffer& buffer)
+        -> void;
+    auto dispatch(dispatch_job job) -> void;
+    auto async_retry_dispatch(void) -> void;
+    auto retry_dispatch(
+        boost::beast::error_code const& error)
+        -> void;
+    auto handle_dispatch_job(
+        dispatch_job const& job,
+        ohno::decoder& decoder)
+        -> void;
+    auto handle_message_create(message_create_event const& event) -> void;
 
     std::filesystem::path const m_path_config;
     ohno::config& m_config;
-    hosts_type const m_hosts_http;
+    ohno::resolver_cache& m_resolver;
     boost::asio::io_context& m_context_io;
+    strand_type m_strand; // every handler touching connection state runs here
     boost::asio::ssl::context& m_context_ssl;
-    boost::beast::flat_buffer m_buffer_event;
-    ws_stream_type m_stream_gateway;
+    ohno::rest_client m_client_rest; // the workers start requests, they run on the io context
+    std::string const m_url_gateway;
+    ohno::buffer_pool m_pool_buffer; // before anything holding its buffers
+    gateway_writer_counters m_counters_writer;
+    connection_type m_connection; // empty while connecting, unless the gateway asked for a reconnect
+    uint64_t m_count_connection;
+    bool m_is_connecting;
+    boost::asio::steady_timer m_timer_reconnect;
+    ohno::backoff m_backoff;
+    std::unique_ptr< ohno::decoder > m_decoder;
+    ohno::arena m_arena;
     uint32_t m_interval_heartbeat;
     boost::asio::steady_timer m_timer_heartbeat;
+    ohno::heartbeat_tracker m_tracker_heartbeat;
     connection_status_type m_status_connection;
     bool m_is_running;
-    ko3_timer_type m_timer_ko3;
+    ohno::guild_cache m_cache_guild;
+    std::atomic< ko3_timer_type > m_timer_ko3;
+    boost::asio::steady_timer m_timer_backpressure;
+    std::list< boost::asio::steady_timer > m_timers_delayed; // one per run_after still waiting
+    std::minstd_rand m_random;
+    std::optional< dispatch_job > m_job_pending;
+    ohno::dispatcher m_dispatcher; // last, so that the workers are gone before anything they use
 };
 
 } // namespace qyzk::ohno
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include <boost/log/trivial.hpp>
+
+#include "./buffer_pool.h"
+
+namespace
+{
+
+using qyzk::ohno::buffer_size_classes;
+
+// index of the smallest class holding size, or one past the last class
+auto get_size_class(std::size_t const size) noexcept -> std::size_t
+{
+    auto const found = std::lower_bound(buffer_size_classes.begin(), buffer_size_classes.end(), size);
+    return static_cast< std::size_t >(found - buffer_size_classes.begin());
+}
+
+} // namespace
+
+namespace qyzk::ohno
+{
+
+pooled_buffer::pooled_buffer(void) noexcept
+    : m_pool(nullptr)
+    , m_buffer()
+{
+}
+
+pooled_buffer::pooled_buffer(
+    ohno::buffer_pool& pool,
+    boost::beast::flat_buffer buffer) noexcept
+    : m_pool(&pool)
+    , m_buffer(std::move(buffer))
+{
+}
+
+pooled_buffer::pooled_buffer(pooled_buffer&& other) noexcept
+    : m_pool(std::exchange(other.m_pool, nullptr))
+    , m_buffer(std::move(other.m_buffer))
+{
+}
+
+auto pooled_buffer::operator=(pooled_buffer&& other) noexcept -> pooled_buffer&
+{
+    if (this != &other)
+    {
+        reset();
+        m_pool = std::exchange(other.m_pool, nullptr);
+        m_buffer = std::move(other.m_buffer);
+    }
+    return *this;
+}
+
+pooled_buffer::~pooled_buffer(void)
+{
+    reset();
+}
+
+auto pooled_buffer::operator*(void) noexcept -> boost::beast::flat_buffer&
+{
+    return m_buffer;
+}
+
+auto pooled_buffer::operator*(void) const noexcept -> boost::beast::flat_buffer const&
+{
+    return m_buffer;
+}
+
+auto pooled_buffer::operator->(void) noexcept -> boost::beast::flat_buffer*
+{
+    return &m_buffer;
+}
+
+auto pooled_buffer::operator->(void) const noexcept -> boost::beast::flat_buffer const*
+{
+    return &m_buffer;
+}
+
+auto pooled_buffer::reset(void) noexcept -> void
+{
+    if (m_pool != nullptr)
+        std::exchange(m_pool, nullptr)->release(m_buffer);
+
+    // frees the buffer when the pool did not keep it
+    m_buffer = boost::beast::flat_buffer();
+}
+
+buffer_pool::buffer_pool(
+    std::size_t const buffers_per_class,
+    std::size_t const frames_per_window)
+    : m_buffers_per_class(buffers_per_class)
+    , m_frames_per_window(frames_per_window)
+    , m_mutex()
+    , m_buffers_idle()
+    , m_count_window(0)
+    , m_size_window_current(0)
+    , m_size_window_previous(0)
+    , m_statistics()
+{
+    // release must not allocate, it runs in destructors
+    for (auto& buffers : m_buffers_idle)
+        buffers.reserve(m_buffers_per_class);
+}
+
+auto buffer_pool::acquire(void) -> pooled_buffer
+{
+    {
+        std::lock_guard< std::mutex > lock(m_mutex);
+        for (auto& buffers : m_buffers_idle)
+        {
+            if (buffers.empty())
+                continue;
+
+            auto buffer = std::move(buffers.back());
+            buffers.pop_back();
+            ++m_statistics.count_reused;
+            return { *this, std::move(buffer) };
+        }
+        ++m_statistics.count_allocated;
+    }
+
+    boost::beast::flat_buffer buffer;
+    buffer.reserve(buffer_size_classes.front());
+    return { *this, std::move(buffer) };
+}
+
+auto buffer_pool::record_frame(std::size_t const size) -> void
+{
+    std::vector< boost::beast::flat_buffer > buffers_shrunk;
+    std::size_t size_high_water = 0;
+    {
+        std::lock_guard< std::mutex > lock(m_mutex);
+        ++m_statistics.count_frames[get_size_class(size)];
+        m_statistics.size_frame_max = std::max(m_statistics.size_frame_max, size);
+        m_size_window_current = std::max(m_size_window_current, size);
+
+        if (++m_count_window < m_frames_per_window)
+            return;
+
+        m_size_window_previous = std::exchange(m_size_window_current, 0);
+        m_count_window = 0;
+        size_high_water = m_size_window_previous;
+        buffers_shrunk = shrink();
+    }
+
+    // freed outside the lock when this goes out of scope, these may be megabytes
+    BOOST_LOG_TRIVIAL(debug)
+        << "buffer pool high-water mark is " << size_high_water
+        << " bytes, freed " << buffers_shrunk.size() << " idle buffers above it";
+}
+
+auto buffer_pool::get_statistics(void) const -> buffer_pool_statistics
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+
+    auto statistics = m_statistics;
+    statistics.size_high_water = std::max(m_size_window_current, m_size_window_previous);
+    for (auto const& buffers : m_buffers_idle)
+    {
+        statistics.count_pooled += buffers.size();
+        for (auto const& buffer : buffers)
+            statistics.size_pooled += buffer.capacity();
+    }
+    return statistics;
+}
+
+auto buffer_pool::release(boost::beast::flat_buffer& buffer) noexcept -> void
+{
+    buffer.clear();
+    auto const capacity = buffer.capacity();
+
+    std::lock_guard< std::mutex > lock(m_mutex);
+    if (capacity < buffer_size_classes.front() || capacity > get_size_limit())
+    {
+        ++m_statistics.count_dropped;
+        return;
+    }
+
+    // kept by the largest class it covers, so any buffer taken from a class can hold that class
+    auto& buffers = m_buffers_idle[get_size_class(capacity + 1) - 1];
+    if (buffers.size() >= m_buffers_per_class)
+    {
+        ++m_statistics.count_dropped;
+        return;
+    }
+    buffers.push_back(std::move(buffer));
+}
+
+auto buffer_pool::get_size_limit(void) const noexcept -> std::size_t
+{
+    // flat_buffer grows by doubling, leave room for the slack above the frames themselves
+    auto const size_high_water = std::max(m_size_window_current, m_size_window_previous);
+    auto const size_class = std::min(get_size_class(size_high_water), buffer_size_classes.size() - 1);
+    return 2 * buffer_size_classes[size_class];
+}
+
+auto buffer_pool::shrink(void) -> std::vector< boost::beast::flat_buffer >
+{
+    std::vector< boost::beast::flat_buffer > buffers_shrunk;
+    auto const size_limit = get_size_limit();
+    for (auto& buffers : m_buffers_idle)
+    {
+        auto const end_kept = std::partition(
+            buffers.begin(),
+            buffers.end(),
+            [size_limit](auto const& buffer) { return buffer.capacity() <= size_limit; });
+        std::move(end_kept, buffers.end(), std::back_inserter(buffers_shrunk));
+        buffers.erase(end_kept, buffers.end());
+    }
+    return buffers_shrunk;
+}
+
+} // namespace qyzk::ohno
@@ -0,0 +1,107 @@
+#ifndef __QYZK_OHNO_BUFFER_POOL_H__
+#define __QYZK_OHNO_BUFFER_POOL_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <boost/beast/core/flat_buffer.hpp>
+
+namespace qyzk::ohno
+{
+
+class buffer_pool;
+
+// pooled buffers are kept by the smallest of these their capacity covers
+inline constexpr std::array< std::size_t, 6 > buffer_size_classes {
+    4 * 1024,
+    16 * 1024,
+    64 * 1024,
+    256 * 1024,
+    1024 * 1024,
+    4 * 1024 * 1024,
+};
+
+/*
+ * a flat_buffer on loan from a buffer_pool, it goes back to the pool when the loan ends
+ * a default constructed loan has no pool, its buffer is simply freed
+ */
+class pooled_buffer
+{
+public:
+    pooled_buffer(void) noexcept;
+    pooled_buffer(
+        ohno::buffer_pool& pool,
+        boost::beast::flat_buffer buffer) noexcept;
+    pooled_buffer(pooled_buffer&& other) noexcept;
+    auto operator=(pooled_buffer&& other) noexcept -> pooled_buffer&;
+    ~pooled_buffer(void);
+
+    auto operator*(void) noexcept -> boost::beast::flat_buffer&;
+    auto operator*(void) const noexcept -> boost::beast::flat_buffer const&;
+    auto operator->(void) noexcept -> boost::beast::flat_buffer*;
+    auto operator->(void) const noexcept -> boost::beast::flat_buffer const*;
+
+    // ends the loan early, the buffer is left empty
+    auto reset(void) noexcept -> void;
+
+private:
+    ohno::buffer_pool* m_pool;
+    boost::beast::flat_buffer m_buffer;
+}; // class qyzk::ohno::pooled_buffer
+
+struct buffer_pool_statistics
+{
+    // frames counted by size class, the last one is for frames above the largest class
+    std::array< uint64_t, buffer_size_classes.size() + 1 > count_frames;
+    std::size_t size_frame_max;
+    std::size_t size_high_water;
+    std::size_t count_pooled;
+    std::size_t size_pooled;
+    uint64_t count_allocated;
+    uint64_t count_reused;
+    uint64_t count_dropped;
+};
+
+/*
+ * receive buffers shared by the gateway reader and the dispatch workers, safe to use from any thread
+ * buffers beyond what recent frames needed are not kept, so one huge frame doesn't pin its memory
+ */
+class buffer_pool
+{
+public:
+    // the high-water mark covers the last one to two windows of frames
+    buffer_pool(
+        std::size_t const buffers_per_class,
+        std::size_t const frames_per_window);
+
+    buffer_pool(buffer_pool const&) = delete;
+    auto operator=(buffer_pool const&) -> buffer_pool& = delete;
+
+    // the smallest idle buffer, or a new one of the smallest class
+    auto acquire(void) -> pooled_buffer;
+    auto record_frame(std::size_t const size) -> void;
+    auto get_statistics(void) const -> buffer_pool_statistics;
+
+private:
+    friend class pooled_buffer;
+
+    auto release(boost::beast::flat_buffer& buffer) noexcept -> void;
+    auto get_size_limit(void) const noexcept -> std::size_t;
+    auto shrink(void) -> std::vector< boost::beast::flat_buffer >;
+
+    std::size_t const m_buffers_per_class;
+    std::size_t const m_frames_per_window;
+    mutable std::mutex m_mutex;
+    std::array< std::vector< boost::beast::flat_buffer >, buffer_size_classes.size() > m_buffers_idle;
+    std::size_t m_count_window;
+    std::size_t m_size_window_current;
+    std::size_t m_size_window_previous;
+    buffer_pool_statistics m_statistics;
+}; // class qyzk::ohno::buffer_pool
+
+} // namespace qyzk::ohno
+
+#endif
@@ -3,8 +3,10 @@
 
 /*
  * an shitty implemetaion of cache managing
+ * safe to share between threads, values are handed out as copies for that reason
  */
 
+#include <mutex>
 #include <optional>
 #include <tuple>
 
@@ -21,25 +23,58 @@ public:
     using key_type = typename descriptor::key_type;
     static_assert(std::is_convertible_v< std::underlying_type_t< key_type >, std::size_t >);
 
+    cache(void) = default;
+
+    cache(cache const& other)
+        : m_mutex()
+        , m_cache(other.snapshot())
+    {
+    }
+
+    auto operator=(cache const& other) -> cache&
+    {
+        auto values = other.snapshot();
+        std::lock_guard< std::mutex > lock(m_mutex);
+        m_cache = std::move(values);
+        return *this;
+    }
+
     template <key_type index>
-    constexpr auto has() const noexcept -> bool
+    auto has() const -> bool
     {
+        std::lock_guard< std::mutex > lock(m_mutex);
         return std::get< static_cast< std::size_t >(index) >(m_cache).has_value();
     }
 
     template <key_type index>
-    constexpr auto get() const noexcept -> auto const&
+    auto get() const
     {
+        std::lock_guard< std::mutex > lock(m_mutex);
         return std::get< static_cast< std::size_t >(index) >(m_cache).value();
     }
 
     template <key_type index, typename value_type>
-    auto set(value_type&& value) noexcept
+    auto set(value_type&& value)
     {
-        std::get< static_cast< std::size_t >(index) >(m_cache) = value;
+        std::lock_guard< std::mutex > lock(m_mutex);
+        std::get< static_cast< std::size_t >(index) >(m_cache) = std::forward< value_type >(value);
+    }
+
+    template <key_type index>
+    auto reset()
+    {
+        std::lock_guard< std::mutex > lock(m_mutex);
+        std::get< static_cast< std::size_t >(index) >(m_cache).reset();
     }
 
 private:
+    auto snapshot(void) const -> std::tuple< std::optional< types >... >
+    {
+        std::lock_guard< std::mutex > lock(m_mutex);
+        return m_cache;
+    }
+
+    mutable std::mutex m_mutex;
     std::tuple< std::optional< types >... > m_cache;
 
     static_assert(descriptor::number() == std::tuple_size< decltype(m_cache) >());
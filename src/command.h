@@ -1,26 +1,50 @@
 #ifndef __QYZK_OHNO_COMMAND_H__
 #define __QYZK_OHNO_COMMAND_H__
 
+#include "./gateway_writer.h"
 #include "./http_request.h"
 
 namespace qyzk::ohno
 {
 
+struct identify_option
+{
+    uint32_t intents;
+    uint32_t large_threshold;
+    bool guild_subscriptions;
+};
+
+// commands are queued on the connection's writer, the handler is called once the frame is out
+auto write_payload(
+    gateway_writer& writer,
+    nlohmann::json const& payload,
+    encoding_type const encoding,
+    write_priority_type const priority,
+    gateway_writer::handler_type handler)
+    -> void;
+
 auto identify(
-    ws_stream_type& stream,
-    std::string const token)
+    gateway_writer& writer,
+    std::string_view const token,
+    identify_option const& option,
+    encoding_type const encoding,
+    gateway_writer::handler_type handler = nullptr)
     -> void;
 
 auto heartbeat(
-    ws_stream_type& stream,
-    uint32_t const sequence)
+    gateway_writer& writer,
+    uint32_t const sequence,
+    encoding_type const encoding,
+    gateway_writer::handler_type handler = nullptr)
     -> void;
 
 auto resume(
-    ws_stream_type& stream,
-    std::string const token,
-    std::string const id_session,
-    uint32_t const sequence)
+    gateway_writer& writer,
+    std::string_view const token,
+    std::string_view const id_session,
+    uint32_t const sequence,
+    encoding_type const encoding,
+    gateway_writer::handler_type handler = nullptr)
     -> void;
 
 } // namespace qyzk::ohno
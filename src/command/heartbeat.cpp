@@ -1,4 +1,5 @@
 #include "../command.h"
+#include "../frame_template.h"
 #include "../opcode.h"
 
 namespace qyzk::ohno
@@ -6,15 +7,31 @@ namespace qyzk::ohno
 
 using json = nlohmann::json;
 
-auto heartbeat(ws_stream_type& stream, uint32_t const sequence) -> void
+auto heartbeat(
+    gateway_writer& writer,
+    uint32_t const sequence,
+    encoding_type const encoding,
+    gateway_writer::handler_type handler)
+    -> void
 {
-    json payload;
-    payload["op"] = static_cast< uint32_t >(opcode_type::heartbeat);
+    if (encoding == encoding_type::etf)
+    {
+        json payload;
+        payload["op"] = static_cast< uint32_t >(opcode_type::heartbeat);
+        if (sequence == 0)
+            payload["d"] = nullptr;
+        else
+            payload["d"] = sequence;
+        write_payload(writer, payload, encoding, write_priority_type::heartbeat, std::move(handler));
+        return;
+    }
+
+    auto frame = writer.acquire_frame();
     if (sequence == 0)
-        payload["d"] = nullptr;
+        render_frame(heartbeat_frame, frame, nullptr);
     else
-        payload["d"] = sequence;
-    stream.write(boost::asio::buffer(payload.dump()));
+        render_frame(heartbeat_frame, frame, sequence);
+    writer.write(std::move(frame), write_priority_type::heartbeat, std::move(handler));
 }
 
 } // namespace qyzk::ohno
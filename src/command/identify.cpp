@@ -1,4 +1,5 @@
 #include "../command.h"
+#include "../frame_template.h"
 #include "../opcode.h"
 
 namespace qyzk::ohno
@@ -6,8 +7,28 @@ namespace qyzk::ohno
 
 using json = nlohmann::json;
 
-auto identify(ws_stream_type& stream, std::string token) -> void
+auto identify(
+    gateway_writer& writer,
+    std::string_view const token,
+    identify_option const& option,
+    encoding_type const encoding,
+    gateway_writer::handler_type handler)
+    -> void
 {
+    if (encoding == encoding_type::json)
+    {
+        auto frame = writer.acquire_frame();
+        render_frame(
+            identify_frame,
+            frame,
+            token,
+            option.intents,
+            option.large_threshold,
+            option.guild_subscriptions);
+        writer.write(std::move(frame), write_priority_type::normal, std::move(handler));
+        return;
+    }
+
     json properties;
     properties["$os"] = "Archlinux";
     properties["$browser"] = "oh no bot";
@@ -21,12 +42,15 @@ auto identify(ws_stream_type& stream, std::string token) -> void
     data["token"] = token;
     data["properties"] = properties;
     data["presence"] = presence;
+    data["intents"] = option.intents;
+    data["large_threshold"] = option.large_threshold;
+    data["guild_subscriptions"] = option.guild_subscriptions;
 
     json payload;
     payload["d"] = data;
     payload["op"] = static_cast< uint32_t >(opcode_type::identify);
 
-    stream.write(boost::asio::buffer(payload.dump()));
+    write_payload(writer, payload, encoding, write_priority_type::normal, std::move(handler));
 }
 
 } // namespace qyzk::ohno
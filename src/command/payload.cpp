@@ -0,0 +1,19 @@
+#include "../command.h"
+#include "../etf.h"
+
+namespace qyzk::ohno
+{
+
+auto write_payload(
+    gateway_writer& writer,
+    nlohmann::json const& payload,
+    encoding_type const encoding,
+    write_priority_type const priority,
+    gateway_writer::handler_type handler)
+    -> void
+{
+    auto frame = encoding == encoding_type::etf ? encode_etf(payload) : payload.dump();
+    writer.write(std::move(frame), priority, std::move(handler));
+}
+
+} // namespace qyzk::ohno
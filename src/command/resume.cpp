@@ -1,4 +1,5 @@
 #include "../command.h"
+#include "../frame_template.h"
 #include "../opcode.h"
 
 namespace qyzk::ohno
@@ -7,12 +8,22 @@ namespace qyzk::ohno
 using json = nlohmann::json;
 
 auto resume(
-    ws_stream_type& stream,
-    std::string const token,
-    std::string const id_session,
-    uint32_t const sequence)
+    gateway_writer& writer,
+    std::string_view const token,
+    std::string_view const id_session,
+    uint32_t const sequence,
+    encoding_type const encoding,
+    gateway_writer::handler_type handler)
     -> void
 {
+    if (encoding == encoding_type::json)
+    {
+        auto frame = writer.acquire_frame();
+        render_frame(resume_frame, frame, token, id_session, sequence);
+        writer.write(std::move(frame), write_priority_type::normal, std::move(handler));
+        return;
+    }
+
     json data;
     data["token"] = token;
     data["session_id"] = id_session;
@@ -22,7 +33,7 @@ auto resume(
     payload["op"] = static_cast< uint32_t >(opcode_type::resume);
     payload["d"] = data;
 
-    stream.write(boost::asio::buffer(payload.dump()));
+    write_payload(writer, payload, encoding, write_priority_type::normal, std::move(handler));
 }
 
 } // namespace qyzk::ohno
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <exception>
 #include <fstream>
 
@@ -15,9 +16,57 @@ auto get_http_api_location(uint32_t const version_api_http) -> std::string
     return "/api/v" + std::to_string(version_api_http);
 }
 
-auto get_gateway_option(uint32_t const version_gateway) -> std::string
+auto get_gateway_option(
+    uint32_t const version_gateway,
+    qyzk::ohno::compression_type const compression,
+    qyzk::ohno::encoding_type const encoding)
+    -> std::string
 {
-    return "?v=" + std::to_string(version_gateway) + "&encoding=json";
+    auto option = "?v=" + std::to_string(version_gateway);
+    if (encoding == qyzk::ohno::encoding_type::etf)
+        option += "&encoding=etf";
+    else
+        option += "&encoding=json";
+    if (compression == qyzk::ohno::compression_type::zlib_stream)
+        option += "&compress=zlib-stream";
+    return option;
+}
+
+auto get_compression(nlohmann::json const& config) -> qyzk::ohno::compression_type
+{
+    auto const gateway = config.value("gateway", nlohmann::json::object());
+    if (gateway.value("compress", "") == "zlib-stream")
+        return qyzk::ohno::compression_type::zlib_stream;
+    else
+        return qyzk::ohno::compression_type::none;
+}
+
+auto get_encoding(nlohmann::json const& config) -> qyzk::ohno::encoding_type
+{
+    auto const gateway = config.value("gateway", nlohmann::json::object());
+    if (gateway.value("encoding", "json") == "etf")
+        return qyzk::ohno::encoding_type::etf;
+    else
+        return qyzk::ohno::encoding_type::json;
+}
+
+auto get_parser(nlohmann::json const& config) -> qyzk::ohno::parser_type
+{
+    auto const gateway = config.value("gateway", nlohmann::json::object());
+    if (gateway.value("parser", "simdjson") == "nlohmann")
+        return qyzk::ohno::parser_type::nlohmann;
+    else
+        return qyzk::ohno::parser_type::simdjson;
+}
+
+// intents are derived from the registered event handlers unless set explicitly
+auto get_intents(nlohmann::json const& config) -> std::optional< uint32_t >
+{
+    auto const gateway = config.value("gateway", nlohmann::json::object());
+    auto const intents = gateway.find("intents");
+    if (intents == gateway.end() || intents->is_null())
+        return std::nullopt;
+    return intents->get< uint32_t >();
 }
 
 } // namespace
@@ -38,15 +87,41 @@ config::config(nlohmann::json const& config)
     : m_hostname_discord("discordapp.com")
     , m_version_api_http(config["version"]["http_api"])
     , m_version_gateway(config["version"]["gateway"])
+    , m_compression_gateway(::get_compression(config))
+    , m_encoding_gateway(::get_encoding(config))
+    , m_intents_gateway(::get_intents(config))
+    , m_parser_gateway(::get_parser(config))
+    , m_streaming_gateway(config.value("gateway", nlohmann::json::object()).value("streaming", false))
+    , m_cache_guilds_gateway(config.value("gateway", nlohmann::json::object()).value("cache_guilds", false))
+    , m_large_threshold(config.value("gateway", nlohmann::json::object()).value("large_threshold", 50u))
+    , m_guild_subscriptions(config.value("gateway", nlohmann::json::object()).value("guild_subscriptions", true))
+    , m_workers_dispatch(std::max(config.value("dispatch", nlohmann::json::object()).value("workers", 2u), 1u))
+    , m_size_queue_dispatch(config.value("dispatch", nlohmann::json::object()).value("queue_size", 1024u))
+    , m_threads_io(std::max(config.value("io", nlohmann::json::object()).value("threads", 1u), 1u))
+    , m_ttl_dns(config.value("dns", nlohmann::json::object()).value("ttl", 300u))
     , m_location_api_http(::get_http_api_location(m_version_api_http))
-    , m_option_gateway(::get_gateway_option(m_version_gateway))
+    , m_option_gateway(::get_gateway_option(m_version_gateway, m_compression_gateway, m_encoding_gateway))
     , m_token(config["token"])
     , m_cache()
 {
     using key = cache_type::key_type;
     auto const& json_cache = config["cache"];
-    m_cache.set< key::session_id >(json_cache["session_id"]);
+    // saved as an empty string when there was no session to resume
+    auto const session_id = json_cache["session_id"].get< std::string >();
+    if (!session_id.empty())
+        m_cache.set< key::session_id >(session_id);
     m_cache.set< key::last_event_sequence >(json_cache["last_event_sequence"]);
+
+    // left out by older config files
+    auto const gateway_url = json_cache.value("gateway_url", std::string());
+    if (!gateway_url.empty())
+    {
+        m_cache.set< key::gateway_url >(gateway_url);
+        m_cache.set< key::gateway_url_expiry >(json_cache.value("gateway_url_expiry", int64_t(0)));
+    }
+    auto const resume_gateway_url = json_cache.value("resume_gateway_url", std::string());
+    if (!resume_gateway_url.empty())
+        m_cache.set< key::resume_gateway_url >(resume_gateway_url);
 }
 
 auto config::get_discord_hostname(void) const noexcept -> std::string const&
@@ -54,11 +129,61 @@ auto config::get_discord_hostname(void) const noexcept -> std::string const&
     return m_hostname_discord;
 }
 
+auto config::get_dispatch_queue_size(void) const noexcept -> uint32_t
+{
+    return m_size_queue_dispatch;
+}
+
+auto config::get_dispatch_workers(void) const noexcept -> uint32_t
+{
+    return m_workers_dispatch;
+}
+
+auto config::get_gateway_compression(void) const noexcept -> compression_type
+{
+    return m_compression_gateway;
+}
+
+auto config::get_gateway_encoding(void) const noexcept -> encoding_type
+{
+    return m_encoding_gateway;
+}
+
+auto config::get_gateway_intents(void) const noexcept -> std::optional< uint32_t > const&
+{
+    return m_intents_gateway;
+}
+
+auto config::get_guild_subscriptions(void) const noexcept -> bool
+{
+    return m_guild_subscriptions;
+}
+
+auto config::get_large_threshold(void) const noexcept -> uint32_t
+{
+    return m_large_threshold;
+}
+
 auto config::get_gateway_option(void) const noexcept -> std::string const&
 {
     return m_option_gateway;
 }
 
+auto config::get_gateway_parser(void) const noexcept -> parser_type
+{
+    return m_parser_gateway;
+}
+
+auto config::get_gateway_streaming(void) const noexcept -> bool
+{
+    return m_streaming_gateway;
+}
+
+auto config::get_gateway_cache_guilds(void) const noexcept -> bool
+{
+    return m_cache_guilds_gateway;
+}
+
 auto config::get_gateway_version(void) const noexcept -> uint32_t
 {
     return m_version_gateway;
@@ -74,6 +199,16 @@ auto config::get_http_api_version(void) const noexcept -> uint32_t
     return m_version_api_http;
 }
 
+auto config::get_io_threads(void) const noexcept -> uint32_t
+{
+    return m_threads_io;
+}
+
+auto config::get_dns_ttl(void) const noexcept -> uint32_t
+{
+    return m_ttl_dns;
+}
+
 auto config::get_token(void) const noexcept -> std::string const&
 {
     return m_token;
@@ -117,13 +252,68 @@ auto save_config(std::filesystem::path const& path_config, ohno::config const& c
     else
         json_cache["last_event_sequence"] = 0;
 
+    if (cache.has< key::gateway_url >())
+        json_cache["gateway_url"] = cache.get< key::gateway_url >();
+    else
+        json_cache["gateway_url"] = "";
+
+    if (cache.has< key::gateway_url_expiry >())
+        json_cache["gateway_url_expiry"] = cache.get< key::gateway_url_expiry >();
+    else
+        json_cache["gateway_url_expiry"] = 0;
+
+    if (cache.has< key::resume_gateway_url >())
+        json_cache["resume_gateway_url"] = cache.get< key::resume_gateway_url >();
+    else
+        json_cache["resume_gateway_url"] = "";
+
     nlohmann::json version;
     version["http_api"] = config.get_http_api_version();
     version["gateway"] = config.get_gateway_version();
 
+    nlohmann::json gateway;
+    if (config.get_gateway_compression() == compression_type::zlib_stream)
+        gateway["compress"] = "zlib-stream";
+    else
+        gateway["compress"] = "";
+
+    if (config.get_gateway_encoding() == encoding_type::etf)
+        gateway["encoding"] = "etf";
+    else
+        gateway["encoding"] = "json";
+
+    if (config.get_gateway_intents())
+        gateway["intents"] = *config.get_gateway_intents();
+    else
+        gateway["intents"] = nullptr;
+
+    if (config.get_gateway_parser() == parser_type::nlohmann)
+        gateway["parser"] = "nlohmann";
+    else
+        gateway["parser"] = "simdjson";
+
+    gateway["large_threshold"] = config.get_large_threshold();
+    gateway["guild_subscriptions"] = config.get_guild_subscriptions();
+    gateway["streaming"] = config.get_gateway_streaming();
+    gateway["cache_guilds"] = config.get_gateway_cache_guilds();
+
+    nlohmann::json dispatch;
+    dispatch["workers"] = config.get_dispatch_workers();
+    dispatch["queue_size"] = config.get_dispatch_queue_size();
+
+    nlohmann::json io;
+    io["threads"] = config.get_io_threads();
+
+    nlohmann::json dns;
+    dns["ttl"] = config.get_dns_ttl();
+
     nlohmann::json json_config;
     json_config["token"] = config.get_token();
     json_config["version"] = version;
+    json_config["gateway"] = gateway;
+    json_config["dispatch"] = dispatch;
+    json_config["io"] = io;
+    json_config["dns"] = dns;
     json_config["cache"] = json_cache;
 
     std::ofstream config_file(path_config, std::ios_base::trunc);
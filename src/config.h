@@ -2,6 +2,7 @@
 #define __QYZK_OHNO_CONFIG_H__
 
 #include <filesystem>
+#include <optional>
 #include <string>
 
 #include <nlohmann/json.hpp>
@@ -18,25 +19,60 @@ public:
     {
         session_id = 0,
         last_event_sequence = 1,
+        gateway_url = 2,
+        gateway_url_expiry = 3, // seconds since the epoch
+        resume_gateway_url = 4, // belongs to the session
     };
 
     static constexpr auto number() noexcept -> std::size_t
     {
-        return 2;
+        return 5;
     }
 }; // class config_cache_descriptor
 
+enum class compression_type
+{
+    none,
+    zlib_stream,
+}; // enum class compression_type
+
+enum class encoding_type
+{
+    json,
+    etf,
+}; // enum class encoding_type
+
+enum class parser_type
+{
+    nlohmann,
+    simdjson,
+}; // enum class parser_type
+
 class config
 {
 public:
-    using cache_type = qyzk::cache< config_cache_descriptor, std::string, uint32_t >;
+    using cache_type = qyzk::cache< config_cache_descriptor, std::string, uint32_t, std::string, int64_t, std::string >;
 
     config(nlohmann::json const& config);
 
     auto get_discord_hostname(void) const noexcept -> std::string const&;
+    auto get_dispatch_queue_size(void) const noexcept -> uint32_t;
+    auto get_dispatch_workers(void) const noexcept -> uint32_t;
+    // seconds a resolved address is used before it's looked up again
+    auto get_dns_ttl(void) const noexcept -> uint32_t;
+    auto get_gateway_compression(void) const noexcept -> compression_type;
+    auto get_gateway_encoding(void) const noexcept -> encoding_type;
+    auto get_gateway_intents(void) const noexcept -> std::optional< uint32_t > const&;
+    auto get_guild_subscriptions(void) const noexcept -> bool;
+    auto get_large_threshold(void) const noexcept -> uint32_t;
     auto get_gateway_option(void) const noexcept -> std::string const&;
+    auto get_gateway_parser(void) const noexcept -> parser_type;
+    auto get_gateway_streaming(void) const noexcept -> bool;
+    // guild creates are streamed into the guild cache, which takes the guilds intent on top of what the handlers need
+    auto get_gateway_cache_guilds(void) const noexcept -> bool;
     auto get_gateway_version(void) const noexcept -> uint32_t;
     auto get_http_api_location(void) const noexcept -> std::string const&;
+    auto get_io_threads(void) const noexcept -> uint32_t;
     auto get_http_api_version(void) const noexcept -> uint32_t;
     auto get_token(void) const noexcept -> std::string const&;
 
@@ -47,6 +83,18 @@ private:
     std::string const m_hostname_discord;
     uint32_t const m_version_api_http;
     uint32_t const m_version_gateway;
+    compression_type const m_compression_gateway;
+    encoding_type const m_encoding_gateway;
+    std::optional< uint32_t > const m_intents_gateway;
+    parser_type const m_parser_gateway;
+    bool const m_streaming_gateway;
+    bool const m_cache_guilds_gateway;
+    uint32_t const m_large_threshold;
+    bool const m_guild_subscriptions;
+    uint32_t const m_workers_dispatch;
+    uint32_t const m_size_queue_dispatch;
+    uint32_t const m_threads_io;
+    uint32_t const m_ttl_dns;
     std::string const m_location_api_http;
     std::string const m_option_gateway;
     std::string const m_token;
@@ -0,0 +1,51 @@
+#ifndef __QYZK_OHNO_DECODER_H__
+#define __QYZK_OHNO_DECODER_H__
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+#include "./config.h"
+#include "./envelope.h"
+#include "./event.h"
+
+namespace qyzk::ohno
+{
+
+// frames handed to a decoder keep this many readable bytes past their end
+constexpr std::size_t frame_padding = 64;
+
+/*
+ * reads inbound gateway frames, one implementation per encoding and json backend
+ * decode_* pick out only the fields the bot's handlers use, once per event
+ * string views in the returned events stay valid until the next decode or the end of the frame's arena scope
+ */
+class decoder
+{
+public:
+    virtual ~decoder(void) = default;
+
+    virtual auto scan(std::string_view const frame) -> envelope = 0;
+
+    virtual auto decode_hello(std::string_view const frame) -> hello_event = 0;
+    virtual auto decode_invalid_session(std::string_view const frame) -> invalid_session_event = 0;
+    virtual auto decode_ready(std::string_view const frame) -> ready_event = 0;
+    virtual auto decode_message_create(std::string_view const frame) -> message_create_event = 0;
+    virtual auto decode_guild_delete(std::string_view const frame) -> guild_delete_event = 0;
+    virtual auto decode_channel(std::string_view const frame) -> channel_event = 0;
+    virtual auto decode_guild_role(std::string_view const frame) -> guild_role_event = 0;
+    virtual auto decode_guild_role_delete(std::string_view const frame) -> guild_role_delete_event = 0;
+    virtual auto decode_guild_member(std::string_view const frame) -> guild_member_event = 0;
+}; // class qyzk::ohno::decoder
+
+auto make_nlohmann_decoder(void) -> std::unique_ptr< decoder >;
+auto make_etf_decoder(void) -> std::unique_ptr< decoder >;
+#ifdef OHNO_USE_SIMDJSON
+auto make_simdjson_decoder(void) -> std::unique_ptr< decoder >;
+#endif
+
+auto make_decoder(ohno::config const& config) -> std::unique_ptr< decoder >;
+
+} // namespace qyzk::ohno
+
+#endif
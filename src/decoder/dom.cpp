@@ -0,0 +1,169 @@
+#include <boost/log/trivial.hpp>
+
+#include "../decoder.h"
+#include "../etf.h"
+#include "../payload.h"
+
+namespace
+{
+
+using namespace qyzk::ohno;
+
+auto parse_json(std::string_view const frame) -> payload_type
+{
+    return payload_type::parse(frame.data(), frame.data() + frame.size());
+}
+
+auto get_snowflake(payload_type const& value) -> snowflake_type
+{
+    return parse_snowflake(get_string(value));
+}
+
+/*
+ * builds the whole payload tree in the frame's arena, then reads fields from it
+ * the tree is left in the arena so that the views handed out stay valid until the frame is done
+ */
+template <
+    envelope (*scan_frame)(std::string_view const),
+    payload_type (*parse_frame)(std::string_view const)
+>
+class dom_decoder : public decoder
+{
+public:
+    auto scan(std::string_view const frame) -> envelope override
+    {
+        return scan_frame(frame);
+    }
+
+    auto decode_hello(std::string_view const frame) -> hello_event override
+    {
+        auto const& data = parse_data(frame);
+        return { data["heartbeat_interval"] };
+    }
+
+    auto decode_invalid_session(std::string_view const frame) -> invalid_session_event override
+    {
+        auto const& data = parse_data(frame);
+        return { static_cast< bool >(data) };
+    }
+
+    auto decode_ready(std::string_view const frame) -> ready_event override
+    {
+        auto const& data = parse_data(frame);
+        auto const url = data.find("resume_gateway_url");
+
+        ready_event event;
+        event.session_id = get_string(data["session_id"]);
+        if (url != data.end() && url->is_string())
+            event.resume_gateway_url = get_string(*url);
+        return event;
+    }
+
+    auto decode_message_create(std::string_view const frame) -> message_create_event override
+    {
+        auto const& data = parse_data(frame);
+        auto const guild = data.find("guild_id");
+
+        message_create_event event;
+        event.id = get_snowflake(data["id"]);
+        event.channel_id = get_snowflake(data["channel_id"]);
+        if (guild != data.end() && guild->is_string())
+            event.guild_id = get_snowflake(*guild);
+        event.author_id = get_snowflake(data["author"]["id"]);
+        event.content = get_string(data["content"]);
+        return event;
+    }
+
+    auto decode_guild_delete(std::string_view const frame) -> guild_delete_event override
+    {
+        auto const& data = parse_data(frame);
+        return { get_snowflake(data["id"]) };
+    }
+
+    auto decode_channel(std::string_view const frame) -> channel_event override
+    {
+        auto const& data = parse_data(frame);
+        auto const guild = data.find("guild_id");
+        auto const name = data.find("name");
+
+        channel_event event;
+        event.id = get_snowflake(data["id"]);
+        if (guild != data.end() && guild->is_string())
+            event.guild_id = get_snowflake(*guild);
+        if (name != data.end() && name->is_string())
+            event.name = get_string(*name);
+        return event;
+    }
+
+    auto decode_guild_role(std::string_view const frame) -> guild_role_event override
+    {
+        auto const& data = parse_data(frame);
+        auto const& role = data["role"];
+        return {
+            get_snowflake(data["guild_id"]),
+            get_snowflake(role["id"]),
+            get_string(role["name"]),
+        };
+    }
+
+    auto decode_guild_role_delete(std::string_view const frame) -> guild_role_delete_event override
+    {
+        auto const& data = parse_data(frame);
+        return {
+            get_snowflake(data["guild_id"]),
+            get_snowflake(data["role_id"]),
+        };
+    }
+
+    auto decode_guild_member(std::string_view const frame) -> guild_member_event override
+    {
+        auto const& data = parse_data(frame);
+        auto const& user = data["user"];
+        return {
+            get_snowflake(data["guild_id"]),
+            get_snowflake(user["id"]),
+            get_string(user["username"]),
+        };
+    }
+
+private:
+    static auto parse_data(std::string_view const frame) -> payload_type const&
+    {
+        auto const& payload = construct_in_arena< payload_type >(parse_frame(frame));
+        return payload["d"];
+    }
+};
+
+} // namespace
+
+namespace qyzk::ohno
+{
+
+auto make_nlohmann_decoder(void) -> std::unique_ptr< decoder >
+{
+    return std::make_unique< dom_decoder< scan_envelope, parse_json > >();
+}
+
+auto make_etf_decoder(void) -> std::unique_ptr< decoder >
+{
+    return std::make_unique< dom_decoder< scan_etf_envelope, decode_etf > >();
+}
+
+auto make_decoder(ohno::config const& config) -> std::unique_ptr< decoder >
+{
+    if (config.get_gateway_encoding() == encoding_type::etf)
+        return make_etf_decoder();
+
+    if (config.get_gateway_parser() == parser_type::simdjson)
+    {
+#ifdef OHNO_USE_SIMDJSON
+        return make_simdjson_decoder();
+#else
+        BOOST_LOG_TRIVIAL(warning) << "built without simdjson, falling back to nlohmann json parser";
+#endif
+    }
+
+    return make_nlohmann_decoder();
+}
+
+} // namespace qyzk::ohno
@@ -0,0 +1,150 @@
+#include <simdjson.h>
+
+#include "../decoder.h"
+
+namespace
+{
+
+using namespace qyzk::ohno;
+
+/*
+ * on demand parsing, only the fields asked for are ever materialized
+ * strings are views into the parser's buffer, which is reused on the next frame
+ * the envelope still comes from the hand written scanner, which stops before "d"
+ * whereas simdjson would index the whole frame first
+ */
+class simdjson_decoder : public decoder
+{
+public:
+    static_assert(frame_padding >= simdjson::SIMDJSON_PADDING);
+
+    auto scan(std::string_view const frame) -> envelope override
+    {
+        return scan_envelope(frame);
+    }
+
+    auto decode_hello(std::string_view const frame) -> hello_event override
+    {
+        auto data = iterate_data(frame);
+        uint64_t const interval = data["heartbeat_interval"];
+        return { static_cast< uint32_t >(interval) };
+    }
+
+    auto decode_invalid_session(std::string_view const frame) -> invalid_session_event override
+    {
+        auto document = iterate(frame);
+        bool const is_resumable = document["d"];
+        return { is_resumable };
+    }
+
+    auto decode_ready(std::string_view const frame) -> ready_event override
+    {
+        auto data = iterate_data(frame);
+        std::string_view const session_id = data["session_id"];
+
+        ready_event event { session_id, {} };
+        std::string_view url;
+        if (data["resume_gateway_url"].get_string().get(url) == simdjson::SUCCESS)
+            event.resume_gateway_url = url;
+        return event;
+    }
+
+    auto decode_message_create(std::string_view const frame) -> message_create_event override
+    {
+        auto data = iterate_data(frame);
+
+        message_create_event event;
+        event.id = data["id"].get_uint64_in_string();
+        event.channel_id = data["channel_id"].get_uint64_in_string();
+        uint64_t guild_id;
+        if (data["guild_id"].get_uint64_in_string().get(guild_id) == simdjson::SUCCESS)
+            event.guild_id = guild_id;
+        event.author_id = data["author"]["id"].get_uint64_in_string();
+        event.content = data["content"];
+        return event;
+    }
+
+    auto decode_guild_delete(std::string_view const frame) -> guild_delete_event override
+    {
+        auto data = iterate_data(frame);
+        return { data["id"].get_uint64_in_string() };
+    }
+
+    auto decode_channel(std::string_view const frame) -> channel_event override
+    {
+        auto data = iterate_data(frame);
+
+        channel_event event;
+        event.id = data["id"].get_uint64_in_string();
+        uint64_t guild_id;
+        if (data["guild_id"].get_uint64_in_string().get(guild_id) == simdjson::SUCCESS)
+            event.guild_id = guild_id;
+        std::string_view name;
+        if (data["name"].get_string().get(name) == simdjson::SUCCESS)
+            event.name = name;
+        return event;
+    }
+
+    auto decode_guild_role(std::string_view const frame) -> guild_role_event override
+    {
+        auto data = iterate_data(frame);
+
+        guild_role_event event;
+        event.guild_id = data["guild_id"].get_uint64_in_string();
+        simdjson::ondemand::object role = data["role"];
+        event.role_id = role["id"].get_uint64_in_string();
+        event.name = role["name"];
+        return event;
+    }
+
+    auto decode_guild_role_delete(std::string_view const frame) -> guild_role_delete_event override
+    {
+        auto data = iterate_data(frame);
+
+        guild_role_delete_event event;
+        event.guild_id = data["guild_id"].get_uint64_in_string();
+        event.role_id = data["role_id"].get_uint64_in_string();
+        return event;
+    }
+
+    auto decode_guild_member(std::string_view const frame) -> guild_member_event override
+    {
+        auto data = iterate_data(frame);
+
+        guild_member_event event;
+        event.guild_id = data["guild_id"].get_uint64_in_string();
+        simdjson::ondemand::object user = data["user"];
+        event.user_id = user["id"].get_uint64_in_string();
+        event.username = user["username"];
+        return event;
+    }
+
+private:
+    auto iterate(std::string_view const frame) -> simdjson::ondemand::document
+    {
+        return m_parser.iterate(
+            simdjson::padded_string_view(frame.data(), frame.size(), frame.size() + frame_padding));
+    }
+
+    // the object is only valid while the parser keeps the document, which is until the next iterate
+    auto iterate_data(std::string_view const frame) -> simdjson::ondemand::object
+    {
+        m_document = iterate(frame);
+        return m_document["d"];
+    }
+
+    simdjson::ondemand::parser m_parser;
+    simdjson::ondemand::document m_document;
+};
+
+} // namespace
+
+namespace qyzk::ohno
+{
+
+auto make_simdjson_decoder(void) -> std::unique_ptr< decoder >
+{
+    return std::make_unique< simdjson_decoder >();
+}
+
+} // namespace qyzk::ohno
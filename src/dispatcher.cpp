@@ -0,0 +1,111 @@
+#include <boost/log/trivial.hpp>
+
+#include "./arena.h"
+#include "./dispatcher.h"
+
+namespace
+{
+
+// every worker parses into an arena of its own
+constexpr std::size_t arena_size_initial = 256 * 1024;
+
+} // namespace
+
+namespace qyzk::ohno
+{
+
+dispatcher::dispatcher(
+    ohno::config const& config,
+    handler_type handler)
+    : m_config(config)
+    , m_handler(std::move(handler))
+    , m_queue(config.get_dispatch_queue_size())
+    , m_mutex_idle()
+    , m_condition_idle()
+    , m_is_stopping(false)
+    , m_depth_max(0)
+    , m_count_dispatched(0)
+    , m_count_rejected(0)
+    , m_workers()
+{
+    for (uint32_t index = 0; index < config.get_dispatch_workers(); ++index)
+        m_workers.emplace_back(&dispatcher::work, this);
+}
+
+dispatcher::~dispatcher(void)
+{
+    {
+        std::lock_guard< std::mutex > lock(m_mutex_idle);
+        m_is_stopping = true;
+    }
+    m_condition_idle.notify_all();
+
+    for (auto& worker : m_workers)
+        worker.join();
+}
+
+auto dispatcher::try_dispatch(dispatch_job& job) -> bool
+{
+    if (!m_queue.try_push(job))
+    {
+        ++m_count_rejected;
+        return false;
+    }
+
+    auto const depth = m_queue.size();
+    auto depth_max = m_depth_max.load();
+    while (depth > depth_max && !m_depth_max.compare_exchange_weak(depth_max, depth));
+    ++m_count_dispatched;
+
+    {
+        // a worker checks the queue under the lock before it sleeps, so it either sees the push or gets the notify
+        std::lock_guard< std::mutex > lock(m_mutex_idle);
+        m_condition_idle.notify_one();
+    }
+    return true;
+}
+
+auto dispatcher::get_statistics(void) const noexcept -> dispatch_statistics
+{
+    return {
+        m_queue.size(),
+        m_depth_max.load(),
+        m_count_dispatched.load(),
+        m_count_rejected.load(),
+    };
+}
+
+auto dispatcher::work(void) -> void
+{
+    auto decoder = make_decoder(m_config);
+    ohno::arena arena(arena_size_initial);
+    dispatch_job job;
+
+    for (;;)
+    {
+        if (m_queue.try_pop(job))
+        {
+            try
+            {
+                arena_scope const scope(arena);
+                m_handler(job, *decoder);
+            }
+            catch (std::exception const& error)
+            {
+                BOOST_LOG_TRIVIAL(error) << "failed to handle dispatched event " << events.name(job.event) << ": " << error.what();
+            }
+            job.buffer.reset();
+            continue;
+        }
+
+        std::unique_lock< std::mutex > lock(m_mutex_idle);
+        if (m_is_stopping)
+            return;
+
+        m_condition_idle.wait(
+            lock,
+            [this](void) { return m_is_stopping || m_queue.size() > 0; });
+    }
+}
+
+} // namespace qyzk::ohno
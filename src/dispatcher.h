@@ -0,0 +1,74 @@
+#ifndef __QYZK_OHNO_DISPATCHER_H__
+#define __QYZK_OHNO_DISPATCHER_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "./buffer_pool.h"
+#include "./config.h"
+#include "./decoder.h"
+#include "./event.h"
+#include "./ring.hpp"
+
+namespace qyzk::ohno
+{
+
+// a dispatch event handed from the gateway reader to the workers, the job owns the frame
+struct dispatch_job
+{
+    event_type event;
+    pooled_buffer buffer;
+};
+
+struct dispatch_statistics
+{
+    std::size_t depth;
+    std::size_t depth_max;
+    uint64_t count_dispatched;
+    uint64_t count_rejected;
+};
+
+/*
+ * pool of workers decoding and handling dispatch events off the gateway's io thread
+ * every worker has its own decoder and arena, the handler must be safe to run concurrently
+ */
+class dispatcher
+{
+public:
+    using handler_type = std::function< void(dispatch_job const& job, ohno::decoder& decoder) >;
+
+    dispatcher(
+        ohno::config const& config,
+        handler_type handler);
+    ~dispatcher(void);
+
+    dispatcher(dispatcher const&) = delete;
+    auto operator=(dispatcher const&) -> dispatcher& = delete;
+
+    // moves from job only when the queue had room, otherwise the caller has to hold back and retry
+    auto try_dispatch(dispatch_job& job) -> bool;
+    auto get_statistics(void) const noexcept -> dispatch_statistics;
+
+private:
+    auto work(void) -> void;
+
+    ohno::config const& m_config;
+    handler_type const m_handler;
+    qyzk::ring< dispatch_job > m_queue;
+    std::mutex m_mutex_idle;
+    std::condition_variable m_condition_idle;
+    std::atomic< bool > m_is_stopping;
+    std::atomic< std::size_t > m_depth_max;
+    std::atomic< uint64_t > m_count_dispatched;
+    std::atomic< uint64_t > m_count_rejected;
+    std::vector< std::thread > m_workers;
+}; // class qyzk::ohno::dispatcher
+
+} // namespace qyzk::ohno
+
+#endif
@@ -0,0 +1,220 @@
+#include <exception>
+
+#include "./envelope.h"
+
+namespace
+{
+
+class envelope_scan_error : public std::exception
+{
+public:
+    virtual auto what(void) const noexcept -> const char* override
+    {
+        return "failed to scan gateway payload envelope";
+    }
+};
+
+class scanner
+{
+public:
+    explicit scanner(std::string_view const text)
+        : m_text(text)
+        , m_index(0)
+    {
+    }
+
+    auto peek(void) -> char
+    {
+        skip_whitespace();
+        if (m_index >= m_text.size())
+            throw envelope_scan_error();
+        return m_text[m_index];
+    }
+
+    auto consume(char const expected) -> void
+    {
+        if (peek() != expected)
+            throw envelope_scan_error();
+        ++m_index;
+    }
+
+    auto read_string(void) -> std::string_view
+    {
+        consume('"');
+        auto const begin = m_index;
+        skip_string_body();
+        return m_text.substr(begin, m_index - begin - 1);
+    }
+
+    auto read_unsigned(void) -> uint32_t
+    {
+        peek();
+        uint32_t value = 0;
+        auto const begin = m_index;
+        for (; m_index < m_text.size() && m_text[m_index] >= '0' && m_text[m_index] <= '9'; ++m_index)
+            value = value * 10 + static_cast< uint32_t >(m_text[m_index] - '0');
+        if (m_index == begin)
+            throw envelope_scan_error();
+        return value;
+    }
+
+    auto read_null(void) -> bool
+    {
+        if (peek() != 'n')
+            return false;
+        if (m_text.substr(m_index, 4) != "null")
+            throw envelope_scan_error();
+        m_index += 4;
+        return true;
+    }
+
+    auto skip_value(void) -> void
+    {
+        switch (peek())
+        {
+        case '"':
+            ++m_index;
+            skip_string_body();
+            break;
+
+        case '{':
+        case '[':
+            skip_container();
+            break;
+
+        default:
+            // numbers and literals run until the next delimiter
+            while (m_index < m_text.size())
+            {
+                auto const c = m_text[m_index];
+                if (c == ',' || c == '}' || c == ']' || is_whitespace(c))
+                    break;
+                ++m_index;
+            }
+        }
+    }
+
+private:
+    static auto is_whitespace(char const c) noexcept -> bool
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    auto skip_whitespace(void) noexcept -> void
+    {
+        while (m_index < m_text.size() && is_whitespace(m_text[m_index]))
+            ++m_index;
+    }
+
+    // expects m_index right after the opening quote, leaves it right after the closing one
+    auto skip_string_body(void) -> void
+    {
+        for (; m_index < m_text.size(); ++m_index)
+        {
+            if (m_text[m_index] == '\\')
+                ++m_index;
+            else if (m_text[m_index] == '"')
+            {
+                ++m_index;
+                return;
+            }
+        }
+        throw envelope_scan_error();
+    }
+
+    // brackets are only counted, nested values are never looked into
+    auto skip_container(void) -> void
+    {
+        std::size_t depth = 0;
+        for (; m_index < m_text.size(); ++m_index)
+        {
+            switch (m_text[m_index])
+            {
+            case '"':
+                ++m_index;
+                skip_string_body();
+                --m_index;
+                break;
+
+            case '{':
+            case '[':
+                ++depth;
+                break;
+
+            case '}':
+            case ']':
+                if (--depth == 0)
+                {
+                    ++m_index;
+                    return;
+                }
+                break;
+            }
+        }
+        throw envelope_scan_error();
+    }
+
+    std::string_view const m_text;
+    std::size_t m_index;
+};
+
+} // namespace
+
+namespace qyzk::ohno
+{
+
+auto scan_envelope(std::string_view const frame) -> envelope
+{
+    envelope result { opcode_type::unknown, std::nullopt, {} };
+    bool has_opcode = false;
+    bool has_sequence = false;
+    bool has_event_name = false;
+
+    scanner scanner(frame);
+    scanner.consume('{');
+    if (scanner.peek() == '}')
+        throw envelope_scan_error();
+
+    // discord puts "d" last, so the scan usually stops before touching the event data
+    while (!(has_opcode && has_sequence && has_event_name))
+    {
+        auto const key = scanner.read_string();
+        scanner.consume(':');
+
+        if (key == "op")
+        {
+            result.opcode = static_cast< opcode_type >(scanner.read_unsigned());
+            has_opcode = true;
+        }
+        else if (key == "s")
+        {
+            if (!scanner.read_null())
+                result.sequence = scanner.read_unsigned();
+            has_sequence = true;
+        }
+        else if (key == "t")
+        {
+            if (!scanner.read_null())
+                result.event_name = scanner.read_string();
+            has_event_name = true;
+        }
+        else
+        {
+            scanner.skip_value();
+        }
+
+        if (scanner.peek() != ',')
+        {
+            scanner.consume('}');
+            break;
+        }
+        scanner.consume(',');
+    }
+
+    if (!has_opcode)
+        throw envelope_scan_error();
+
+    return result;
+}
+
+} // namespace qyzk::ohno
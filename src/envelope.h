@@ -0,0 +1,28 @@
+#ifndef __QYZK_OHNO_ENVELOPE_H__
+#define __QYZK_OHNO_ENVELOPE_H__
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "./opcode.h"
+
+namespace qyzk::ohno
+{
+
+/*
+ * top level fields of a gateway payload, read without building the payload tree
+ * event_name views into the scanned frame, so it lives only as long as the frame
+ */
+struct envelope
+{
+    opcode_type opcode;
+    std::optional< uint32_t > sequence;
+    std::string_view event_name;
+};
+
+auto scan_envelope(std::string_view const frame) -> envelope;
+
+} // namespace qyzk::ohno
+
+#endif
@@ -0,0 +1,575 @@
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <limits>
+
+#include "./etf.h"
+
+using json = nlohmann::json;
+using qyzk::ohno::payload_string_type;
+using qyzk::ohno::payload_type;
+
+namespace
+{
+
+class etf_decode_error : public std::exception
+{
+public:
+    virtual auto what(void) const noexcept -> const char* override
+    {
+        return "failed to decode etf payload";
+    }
+};
+
+class etf_encode_error : public std::exception
+{
+public:
+    virtual auto what(void) const noexcept -> const char* override
+    {
+        return "failed to encode etf payload";
+    }
+};
+
+enum tag : uint8_t
+{
+    new_float = 70,
+    small_integer = 97,
+    integer = 98,
+    float_string = 99,
+    atom = 100,
+    small_tuple = 104,
+    large_tuple = 105,
+    nil = 106,
+    string = 107,
+    list = 108,
+    binary = 109,
+    small_big = 110,
+    large_big = 111,
+    small_atom = 115,
+    map = 116,
+    atom_utf8 = 118,
+    small_atom_utf8 = 119,
+    version = 131,
+};
+
+class reader
+{
+public:
+    explicit reader(std::string_view const data)
+        : m_data(data)
+        , m_index(0)
+    {
+    }
+
+    auto read_u8(void) -> uint8_t
+    {
+        return static_cast< uint8_t >(read_bytes(1)[0]);
+    }
+
+    auto read_u16(void) -> uint16_t
+    {
+        auto const bytes = read_bytes(2);
+        return static_cast< uint16_t >(byte(bytes, 0) << 8 | byte(bytes, 1));
+    }
+
+    auto read_u32(void) -> uint32_t
+    {
+        auto const bytes = read_bytes(4);
+        return byte(bytes, 0) << 24 | byte(bytes, 1) << 16 | byte(bytes, 2) << 8 | byte(bytes, 3);
+    }
+
+    auto read_bytes(std::size_t const size) -> std::string_view
+    {
+        if (m_data.size() - m_index < size)
+            throw etf_decode_error();
+        auto const bytes = m_data.substr(m_index, size);
+        m_index += size;
+        return bytes;
+    }
+
+    auto read_version(void) -> void
+    {
+        if (read_u8() != tag::version)
+            throw etf_decode_error();
+    }
+
+    auto read_term(void) -> payload_type
+    {
+        auto const type = read_u8();
+        switch (type)
+        {
+        case tag::small_integer:
+            return read_u8();
+
+        case tag::integer:
+            return static_cast< int32_t >(read_u32());
+
+        case tag::new_float:
+        {
+            uint64_t const bits = static_cast< uint64_t >(read_u32()) << 32 | read_u32();
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        case tag::float_string:
+            return std::stod(std::string(read_bytes(31)));
+
+        case tag::atom:
+        case tag::atom_utf8:
+            return atom_to_payload(read_bytes(read_u16()));
+
+        case tag::small_atom:
+        case tag::small_atom_utf8:
+            return atom_to_payload(read_bytes(read_u8()));
+
+        case tag::small_tuple:
+            return read_elements(read_u8());
+
+        case tag::large_tuple:
+            return read_elements(read_u32());
+
+        case tag::nil:
+            return payload_type::array();
+
+        case tag::string:
+            return payload_string_type(read_bytes(read_u16()));
+
+        case tag::list:
+        {
+            auto elements = read_elements(read_u32());
+            // proper lists end with nil, anything else is an improper tail
+            auto tail = read_term();
+            if (!tail.is_array() || !tail.empty())
+                elements.push_back(std::move(tail));
+            return elements;
+        }
+
+        case tag::binary:
+            return payload_string_type(read_bytes(read_u32()));
+
+        case tag::small_big:
+            return read_big(read_u8());
+
+        case tag::large_big:
+            return read_big(read_u32());
+
+        case tag::map:
+        {
+            auto const arity = read_u32();
+            auto object = payload_type::object();
+            for (uint32_t i = 0; i < arity; ++i)
+            {
+                auto key = key_to_string(read_term());
+                object[std::move(key)] = read_term();
+            }
+            return object;
+        }
+
+        default:
+            throw etf_decode_error();
+        }
+    }
+
+    // reads a map key or an atom valued field without allocating, nil becomes an empty view
+    auto read_name(void) -> std::string_view
+    {
+        auto const type = read_u8();
+        std::string_view name;
+        switch (type)
+        {
+        case tag::atom:
+        case tag::atom_utf8:
+            name = read_bytes(read_u16());
+            break;
+
+        case tag::small_atom:
+        case tag::small_atom_utf8:
+            name = read_bytes(read_u8());
+            break;
+
+        case tag::binary:
+            return read_bytes(read_u32());
+
+        case tag::string:
+            return read_bytes(read_u16());
+
+        default:
+            throw etf_decode_error();
+        }
+        if (name == "nil")
+            return {};
+        return name;
+    }
+
+    // reads an integer field, nil becomes nullopt
+    auto read_integer(void) -> std::optional< uint32_t >
+    {
+        auto const type = read_u8();
+        switch (type)
+        {
+        case tag::small_integer:
+            return read_u8();
+
+        case tag::integer:
+            return read_u32();
+
+        case tag::atom:
+        case tag::atom_utf8:
+            if (read_bytes(read_u16()) == "nil")
+                return std::nullopt;
+            throw etf_decode_error();
+
+        case tag::small_atom:
+        case tag::small_atom_utf8:
+            if (read_bytes(read_u8()) == "nil")
+                return std::nullopt;
+            throw etf_decode_error();
+
+        default:
+            throw etf_decode_error();
+        }
+    }
+
+    auto skip_term(void) -> void
+    {
+        auto const type = read_u8();
+        switch (type)
+        {
+        case tag::small_integer:
+            read_bytes(1);
+            break;
+
+        case tag::integer:
+            read_bytes(4);
+            break;
+
+        case tag::new_float:
+            read_bytes(8);
+            break;
+
+        case tag::float_string:
+            read_bytes(31);
+            break;
+
+        case tag::atom:
+        case tag::atom_utf8:
+            read_bytes(read_u16());
+            break;
+
+        case tag::small_atom:
+        case tag::small_atom_utf8:
+            read_bytes(read_u8());
+            break;
+
+        case tag::small_tuple:
+            skip_terms(read_u8());
+            break;
+
+        case tag::large_tuple:
+            skip_terms(read_u32());
+            break;
+
+        case tag::nil:
+            break;
+
+        case tag::string:
+            read_bytes(read_u16());
+            break;
+
+        case tag::list:
+            skip_terms(static_cast< std::size_t >(read_u32()) + 1);
+            break;
+
+        case tag::binary:
+            read_bytes(read_u32());
+            break;
+
+        case tag::small_big:
+            read_bytes(static_cast< std::size_t >(read_u8()) + 1);
+            break;
+
+        case tag::large_big:
+            read_bytes(static_cast< std::size_t >(read_u32()) + 1);
+            break;
+
+        case tag::map:
+            skip_terms(static_cast< std::size_t >(read_u32()) * 2);
+            break;
+
+        default:
+            throw etf_decode_error();
+        }
+    }
+
+private:
+    static auto byte(std::string_view const bytes, std::size_t const index) -> uint32_t
+    {
+        return static_cast< uint8_t >(bytes[index]);
+    }
+
+    static auto atom_to_payload(std::string_view const name) -> payload_type
+    {
+        if (name == "nil" || name == "null")
+            return nullptr;
+        if (name == "true")
+            return true;
+        if (name == "false")
+            return false;
+        return payload_string_type(name);
+    }
+
+    static auto key_to_string(payload_type const& key) -> payload_string_type
+    {
+        if (key.is_string())
+            return key.get_ref< payload_string_type const& >();
+        return key.dump();
+    }
+
+    auto read_elements(std::size_t const arity) -> payload_type
+    {
+        auto elements = payload_type::array();
+        for (std::size_t i = 0; i < arity; ++i)
+            elements.push_back(read_term());
+        return elements;
+    }
+
+    auto skip_terms(std::size_t const count) -> void
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            skip_term();
+    }
+
+    auto read_big(std::size_t const size) -> payload_type
+    {
+        auto const sign = read_u8();
+        auto const digits = read_bytes(size);
+        if (size > sizeof(uint64_t))
+            throw etf_decode_error();
+
+        uint64_t value = 0;
+        for (std::size_t i = size; i > 0; --i)
+            value = value << 8 | byte(digits, i - 1);
+
+        // the gateway only sends integers past 32 bits as bigs, snowflakes and permissions among them,
+        // and the json encoding carries those as strings, so keep the same shape here whatever the magnitude
+        auto const text = std::to_string(value);
+        return payload_string_type(sign == 0 ? text : "-" + text);
+    }
+
+    std::string_view const m_data;
+    std::size_t m_index;
+};
+
+class writer
+{
+public:
+    auto write_version(void) -> void
+    {
+        write_u8(tag::version);
+    }
+
+    auto write_term(json const& value) -> void
+    {
+        switch (value.type())
+        {
+        case json::value_t::null:
+            write_atom("nil");
+            break;
+
+        case json::value_t::boolean:
+            write_atom(value.get< bool >() ? "true" : "false");
+            break;
+
+        case json::value_t::number_unsigned:
+            write_unsigned(value.get< uint64_t >(), false);
+            break;
+
+        case json::value_t::number_integer:
+        {
+            auto const number = value.get< int64_t >();
+            if (number >= std::numeric_limits< int32_t >::min() && number < 0)
+            {
+                write_u8(tag::integer);
+                write_u32(static_cast< uint32_t >(number));
+            }
+            else if (number < 0)
+                write_unsigned(-static_cast< uint64_t >(number), true);
+            else
+                write_unsigned(static_cast< uint64_t >(number), false);
+            break;
+        }
+
+        case json::value_t::number_float:
+        {
+            auto const number = value.get< double >();
+            uint64_t bits;
+            std::memcpy(&bits, &number, sizeof(bits));
+            write_u8(tag::new_float);
+            write_u32(static_cast< uint32_t >(bits >> 32));
+            write_u32(static_cast< uint32_t >(bits));
+            break;
+        }
+
+        case json::value_t::string:
+            write_binary(value.get_ref< std::string const& >());
+            break;
+
+        case json::value_t::array:
+            if (!value.empty())
+            {
+                write_u8(tag::list);
+                write_u32(static_cast< uint32_t >(value.size()));
+                for (auto const& element : value)
+                    write_term(element);
+            }
+            write_u8(tag::nil);
+            break;
+
+        case json::value_t::object:
+            write_u8(tag::map);
+            write_u32(static_cast< uint32_t >(value.size()));
+            for (auto const& [key, element] : value.items())
+            {
+                write_atom(key);
+                write_term(element);
+            }
+            break;
+
+        default:
+            throw etf_encode_error();
+        }
+    }
+
+    auto get(void) && -> std::string
+    {
+        return std::move(m_buffer);
+    }
+
+private:
+    auto write_u8(uint8_t const value) -> void
+    {
+        m_buffer.push_back(static_cast< char >(value));
+    }
+
+    auto write_u16(uint16_t const value) -> void
+    {
+        write_u8(static_cast< uint8_t >(value >> 8));
+        write_u8(static_cast< uint8_t >(value));
+    }
+
+    auto write_u32(uint32_t const value) -> void
+    {
+        write_u16(static_cast< uint16_t >(value >> 16));
+        write_u16(static_cast< uint16_t >(value));
+    }
+
+    auto write_atom(std::string_view const name) -> void
+    {
+        if (name.size() <= std::numeric_limits< uint8_t >::max())
+        {
+            write_u8(tag::small_atom_utf8);
+            write_u8(static_cast< uint8_t >(name.size()));
+        }
+        else if (name.size() <= std::numeric_limits< uint16_t >::max())
+        {
+            write_u8(tag::atom_utf8);
+            write_u16(static_cast< uint16_t >(name.size()));
+        }
+        else
+            throw etf_encode_error();
+        m_buffer.append(name);
+    }
+
+    auto write_binary(std::string_view const data) -> void
+    {
+        write_u8(tag::binary);
+        write_u32(static_cast< uint32_t >(data.size()));
+        m_buffer.append(data);
+    }
+
+    auto write_unsigned(uint64_t const number, bool const is_negative) -> void
+    {
+        if (!is_negative && number <= std::numeric_limits< uint8_t >::max())
+        {
+            write_u8(tag::small_integer);
+            write_u8(static_cast< uint8_t >(number));
+        }
+        else if (!is_negative && number <= static_cast< uint64_t >(std::numeric_limits< int32_t >::max()))
+        {
+            write_u8(tag::integer);
+            write_u32(static_cast< uint32_t >(number));
+        }
+        else
+        {
+            uint8_t size = 0;
+            for (auto rest = number; rest != 0; rest >>= 8)
+                ++size;
+            write_u8(tag::small_big);
+            write_u8(size);
+            write_u8(is_negative ? 1 : 0);
+            for (uint8_t i = 0; i < size; ++i)
+                write_u8(static_cast< uint8_t >(number >> (i * 8)));
+        }
+    }
+
+    std::string m_buffer;
+};
+
+} // namespace
+
+namespace qyzk::ohno
+{
+
+auto decode_etf(std::string_view const frame) -> payload_type
+{
+    reader reader(frame);
+    reader.read_version();
+    return reader.read_term();
+}
+
+auto encode_etf(json const& payload) -> std::string
+{
+    writer writer;
+    writer.write_version();
+    writer.write_term(payload);
+    return std::move(writer).get();
+}
+
+auto scan_etf_envelope(std::string_view const frame) -> envelope
+{
+    envelope result { opcode_type::unknown, std::nullopt, {} };
+    bool has_opcode = false;
+
+    reader reader(frame);
+    reader.read_version();
+    if (reader.read_u8() != tag::map)
+        throw etf_decode_error();
+
+    auto const arity = reader.read_u32();
+    for (uint32_t i = 0; i < arity; ++i)
+    {
+        auto const key = reader.read_name();
+        if (key == "op")
+        {
+            auto const opcode = reader.read_integer();
+            if (!opcode)
+                throw etf_decode_error();
+            result.opcode = static_cast< opcode_type >(*opcode);
+            has_opcode = true;
+        }
+        else if (key == "s")
+            result.sequence = reader.read_integer();
+        else if (key == "t")
+            result.event_name = reader.read_name();
+        else
+            reader.skip_term();
+    }
+
+    if (!has_opcode)
+        throw etf_decode_error();
+
+    return result;
+}
+
+} // namespace qyzk::ohno
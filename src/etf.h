@@ -0,0 +1,27 @@
+#ifndef __QYZK_OHNO_ETF_H__
+#define __QYZK_OHNO_ETF_H__
+
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+#include "./envelope.h"
+#include "./payload.h"
+
+/*
+ * erlang external term format, as used by the gateway with encoding=etf
+ * terms are decoded into the same json structures the json encoding produces
+ */
+
+namespace qyzk::ohno
+{
+
+auto decode_etf(std::string_view const frame) -> payload_type;
+auto encode_etf(nlohmann::json const& payload) -> std::string;
+
+auto scan_etf_envelope(std::string_view const frame) -> envelope;
+
+} // namespace qyzk::ohno
+
+#endif
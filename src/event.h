@@ -1,9 +1,12 @@
 #ifndef __QYZK_OHNO_EVENT_H__
 #define __QYZK_OHNO_EVENT_H__
 
+#include <charconv>
 #include <cstdint>
-#include <map>
-#include <string>
+#include <optional>
+#include <string_view>
+
+#include "./perfect_hash.hpp"
 
 namespace qyzk::ohno
 {
@@ -45,10 +48,126 @@ enum class event_type : uint32_t
     voice_state_update = 32,
     voice_server_update = 33,
     webhooks_update = 34,
+    unknown_event = 35,
 }; // enum class event_type
 
-using events_type = std::map< std::string, event_type >;
-extern events_type events;
+using events_type = qyzk::perfect_hash_table< event_type, static_cast< std::size_t >(event_type::unknown_event) >;
+
+inline constexpr events_type events {
+    {
+        "HELLO",
+        "READY",
+        "RESUMED",
+        "INVALID_SESSION",
+        "CHANNEL_CREATE",
+        "CHANNEL_UPDATE",
+        "CHANNEL_DELETE",
+        "CHANNEL_PINS_UPDATE",
+        "GUILD_CREATE",
+        "GUILD_UPDATE",
+        "GUILD_DELETE",
+        "GUILD_BAN_ADD",
+        "GUILD_BAN_REMOVE",
+        "GUILD_EMOJIS_UPDATE",
+        "GUILD_INTEGRATIONS_UPDATE",
+        "GUILD_MEMBER_ADD",
+        "GUILD_MEMBER_REMOVE",
+        "GUILD_MEMBER_UPDATE",
+        "GUILD_MEMBERS_CHUNK",
+        "GUILD_ROLE_CREATE",
+        "GUILD_ROLE_UPDATE",
+        "GUILD_ROLE_DELETE",
+        "MESSAGE_CREATE",
+        "MESSAGE_UPDATE",
+        "MESSAGE_DELETE",
+        "MESSAGE_DELETE_BULK",
+        "MESSAGE_REACTION_ADD",
+        "MESSAGE_REACTION_REMOVE",
+        "MESSAGE_REACTION_REMOVE_ALL",
+        "PRESENCE_UPDATE",
+        "TYPING_START",
+        "USER_UPDATE",
+        "VOICE_STATE_UPDATE",
+        "VOICE_SERVER_UPDATE",
+        "WEBHOOKS_UPDATE",
+    },
+    event_type::unknown_event,
+};
+
+using snowflake_type = uint64_t;
+
+// snowflakes arrive as decimal strings, 0 is never a valid one
+inline auto parse_snowflake(std::string_view const text) noexcept -> snowflake_type
+{
+    snowflake_type value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+/*
+ * typed gateway events, decoded once per frame and handed to the handlers
+ * views point into the frame or its parsed form and die with it
+ */
+
+struct hello_event
+{
+    uint32_t heartbeat_interval;
+};
+
+struct invalid_session_event
+{
+    bool is_resumable;
+};
+
+struct ready_event
+{
+    std::string_view session_id;
+    std::string_view resume_gateway_url; // empty when the gateway didn't send one
+};
+
+struct message_create_event
+{
+    snowflake_type id;
+    snowflake_type channel_id;
+    std::optional< snowflake_type > guild_id;
+    snowflake_type author_id;
+    std::string_view content;
+};
+
+struct guild_delete_event
+{
+    snowflake_type id;
+};
+
+// channel creates, updates and deletes alike
+struct channel_event
+{
+    snowflake_type id;
+    std::optional< snowflake_type > guild_id; // none for direct message channels
+    std::string_view name;
+};
+
+// role creates and updates
+struct guild_role_event
+{
+    snowflake_type guild_id;
+    snowflake_type role_id;
+    std::string_view name;
+};
+
+struct guild_role_delete_event
+{
+    snowflake_type guild_id;
+    snowflake_type role_id;
+};
+
+// member adds, updates and removes alike
+struct guild_member_event
+{
+    snowflake_type guild_id;
+    snowflake_type user_id;
+    std::string_view username;
+};
 
 } // namespace qyzk::ohno
 
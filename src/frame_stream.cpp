@@ -0,0 +1,321 @@
+#include <charconv>
+
+#include "./frame_stream.h"
+
+namespace
+{
+
+template <typename value_type>
+auto parse_unsigned(std::string_view const text) noexcept -> value_type
+{
+    value_type value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+auto is_streamed(
+    qyzk::ohno::event_type const event,
+    qyzk::ohno::guild_cache const* const cache_guild) noexcept
+    -> bool
+{
+    if (event == qyzk::ohno::event_type::guild_create)
+        return cache_guild != nullptr;
+    return event == qyzk::ohno::event_type::ready;
+}
+
+} // namespace
+
+namespace qyzk::ohno
+{
+
+frame_stream::frame_stream(ohno::guild_cache* const cache_guild)
+    : m_cache_guild(cache_guild)
+    , m_parser(*this)
+    , m_status(frame_stream_status::scanning)
+    , m_contexts()
+    , m_key()
+    , m_opcode(opcode_type::unknown)
+    , m_sequence()
+    , m_event_name()
+    , m_event(event_type::unknown_event)
+    , m_guild_id(0)
+    , m_is_guild_replaced(false)
+    , m_session_id()
+    , m_resume_gateway_url()
+    , m_item()
+    , m_items_pending()
+    , m_size(0)
+{
+}
+
+auto frame_stream::feed(std::string_view const text) -> void
+{
+    m_parser.feed(text);
+    m_size += text.size();
+}
+
+auto frame_stream::finish(void) -> void
+{
+    m_parser.finish();
+    if (m_status == frame_stream_status::scanning)
+        m_status = frame_stream_status::declined;
+    if (m_status == frame_stream_status::declined)
+        m_items_pending.clear();
+}
+
+auto frame_stream::get_size(void) const noexcept -> std::size_t
+{
+    return m_size;
+}
+
+auto frame_stream::get_status(void) const noexcept -> frame_stream_status
+{
+    return m_status;
+}
+
+auto frame_stream::get_envelope(void) const noexcept -> envelope
+{
+    return { m_opcode, m_sequence, m_event_name };
+}
+
+auto frame_stream::get_event(void) const noexcept -> event_type
+{
+    return m_event;
+}
+
+auto frame_stream::get_guild_id(void) const noexcept -> snowflake_type
+{
+    return m_guild_id;
+}
+
+auto frame_stream::get_session_id(void) const noexcept -> std::string_view
+{
+    return m_session_id;
+}
+
+auto frame_stream::get_resume_gateway_url(void) const noexcept -> std::string_view
+{
+    return m_resume_gateway_url;
+}
+
+auto frame_stream::null(void) -> void
+{
+    // a dispatch always names its event, anything else isn't streamed
+    if (get_context() == context_type::root && m_key == "t")
+        m_status = frame_stream_status::declined;
+}
+
+auto frame_stream::boolean(bool const) -> void
+{
+}
+
+auto frame_stream::number(std::string_view const text) -> void
+{
+    if (get_context() != context_type::root)
+        return;
+
+    if (m_key == "op")
+        m_opcode = static_cast< opcode_type >(parse_unsigned< uint32_t >(text));
+    else if (m_key == "s")
+        m_sequence = parse_unsigned< uint32_t >(text);
+}
+
+auto frame_stream::string(std::string_view const value) -> void
+{
+    switch (get_context())
+    {
+    case context_type::root:
+        if (m_key == "t")
+            set_event_name(value);
+        break;
+
+    case context_type::data:
+        if (m_key == "id")
+        {
+            m_guild_id = parse_snowflake(value);
+            flush();
+        }
+        else if (m_key == "session_id")
+        {
+            m_session_id = value;
+        }
+        else if (m_key == "resume_gateway_url")
+        {
+            m_resume_gateway_url = value;
+        }
+        break;
+
+    case context_type::channel:
+        if (m_key == "id")
+            std::get< guild_channel >(m_item).id = parse_snowflake(value);
+        else if (m_key == "name")
+            std::get< guild_channel >(m_item).name = value;
+        break;
+
+    case context_type::role:
+        if (m_key == "id")
+            std::get< guild_role >(m_item).id = parse_snowflake(value);
+        else if (m_key == "name")
+            std::get< guild_role >(m_item).name = value;
+        break;
+
+    case context_type::member_user:
+        if (m_key == "id")
+            std::get< guild_member >(m_item).user_id = parse_snowflake(value);
+        else if (m_key == "username")
+            std::get< guild_member >(m_item).username = value;
+        break;
+
+    default:
+        break;
+    }
+}
+
+auto frame_stream::key(std::string_view const name) -> void
+{
+    m_key = name;
+}
+
+auto frame_stream::start_object(void) -> void
+{
+    auto context = context_type::skipped;
+    if (m_contexts.empty())
+    {
+        context = context_type::root;
+    }
+    else
+    {
+        switch (get_context())
+        {
+        case context_type::root:
+            if (m_key == "d")
+                context = context_type::data;
+            break;
+
+        case context_type::channels:
+            context = context_type::channel;
+            m_item = guild_channel {};
+            break;
+
+        case context_type::roles:
+            context = context_type::role;
+            m_item = guild_role {};
+            break;
+
+        case context_type::members:
+            context = context_type::member;
+            m_item = guild_member {};
+            break;
+
+        case context_type::member:
+            if (m_key == "user")
+                context = context_type::member_user;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    m_contexts.push_back(context);
+    m_key.clear();
+}
+
+auto frame_stream::end_object(void) -> void
+{
+    auto const context = get_context();
+    m_contexts.pop_back();
+
+    if (context == context_type::channel || context == context_type::role || context == context_type::member)
+        emit(std::move(m_item));
+}
+
+auto frame_stream::start_array(void) -> void
+{
+    auto context = context_type::skipped;
+    if (get_context() == context_type::data)
+    {
+        if (m_key == "channels")
+            context = context_type::channels;
+        else if (m_key == "roles")
+            context = context_type::roles;
+        else if (m_key == "members")
+            context = context_type::members;
+    }
+    m_contexts.push_back(context);
+}
+
+auto frame_stream::end_array(void) -> void
+{
+    m_contexts.pop_back();
+}
+
+auto frame_stream::get_context(void) const noexcept -> context_type
+{
+    return m_contexts.empty() ? context_type::skipped : m_contexts.back();
+}
+
+auto frame_stream::set_event_name(std::string_view const name) -> void
+{
+    m_event_name = name;
+    m_event = events.find(name);
+    if (!is_streamed(m_event, m_cache_guild))
+    {
+        m_status = frame_stream_status::declined;
+        m_items_pending.clear();
+        return;
+    }
+
+    m_status = frame_stream_status::streaming;
+    flush();
+}
+
+auto frame_stream::emit(item_type item) -> void
+{
+    // until the frame is known to be a guild create of a known guild, items wait
+    if (m_status != frame_stream_status::streaming || m_event != event_type::guild_create || m_guild_id == 0)
+    {
+        if (m_status != frame_stream_status::declined)
+            m_items_pending.push_back(std::move(item));
+        return;
+    }
+
+    if (auto* const channel = std::get_if< guild_channel >(&item))
+    {
+        if (channel->id == 0)
+            return;
+        m_cache_guild->set_channel(m_guild_id, std::move(*channel));
+    }
+    else if (auto* const role = std::get_if< guild_role >(&item))
+    {
+        if (role->id == 0)
+            return;
+        m_cache_guild->set_role(m_guild_id, std::move(*role));
+    }
+    else if (auto* const member = std::get_if< guild_member >(&item))
+    {
+        if (member->user_id == 0)
+            return;
+        m_cache_guild->set_member(m_guild_id, std::move(*member));
+    }
+}
+
+auto frame_stream::flush(void) -> void
+{
+    if (m_status != frame_stream_status::streaming || m_event != event_type::guild_create || m_guild_id == 0)
+        return;
+
+    // the create lists the whole guild, nothing cached from before it may linger
+    if (!m_is_guild_replaced)
+    {
+        m_cache_guild->remove_guild(m_guild_id);
+        m_is_guild_replaced = true;
+    }
+
+    auto items = std::move(m_items_pending);
+    m_items_pending.clear();
+    for (auto& item : items)
+        emit(std::move(item));
+}
+
+} // namespace qyzk::ohno
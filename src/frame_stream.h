@@ -0,0 +1,100 @@
+#ifndef __QYZK_OHNO_FRAME_STREAM_H__
+#define __QYZK_OHNO_FRAME_STREAM_H__
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "./envelope.h"
+#include "./event.h"
+#include "./guild_cache.h"
+#include "./stream_parser.h"
+
+namespace qyzk::ohno
+{
+
+enum class frame_stream_status
+{
+    scanning, // the event name hasn't come by yet
+    streaming, // an event worth streaming, the bytes fed so far may be dropped
+    declined, // any other event, the frame has to be read whole after all
+};
+
+/*
+ * parses a json gateway frame while it is still arriving, for ready and guild create
+ * channels, roles and members of a guild create go into the guild cache one by one, replacing what it had for the guild
+ * without a guild cache guild creates are declined like any other event
+ */
+class frame_stream : private stream_handler
+{
+public:
+    explicit frame_stream(ohno::guild_cache* const cache_guild);
+
+    auto feed(std::string_view const text) -> void;
+    auto finish(void) -> void;
+
+    // bytes fed so far
+    auto get_size(void) const noexcept -> std::size_t;
+    auto get_status(void) const noexcept -> frame_stream_status;
+    // event_name views into the stream and lives as long as it does
+    auto get_envelope(void) const noexcept -> envelope;
+    auto get_event(void) const noexcept -> event_type;
+    auto get_guild_id(void) const noexcept -> snowflake_type;
+    auto get_session_id(void) const noexcept -> std::string_view;
+    auto get_resume_gateway_url(void) const noexcept -> std::string_view;
+
+private:
+    enum class context_type
+    {
+        root,
+        data,
+        channels,
+        roles,
+        members,
+        channel,
+        role,
+        member,
+        member_user,
+        skipped,
+    };
+
+    using item_type = std::variant< guild_channel, guild_role, guild_member >;
+
+    auto null(void) -> void override;
+    auto boolean(bool const value) -> void override;
+    auto number(std::string_view const text) -> void override;
+    auto string(std::string_view const value) -> void override;
+    auto key(std::string_view const name) -> void override;
+    auto start_object(void) -> void override;
+    auto end_object(void) -> void override;
+    auto start_array(void) -> void override;
+    auto end_array(void) -> void override;
+
+    auto get_context(void) const noexcept -> context_type;
+    auto set_event_name(std::string_view const name) -> void;
+    auto emit(item_type item) -> void;
+    auto flush(void) -> void;
+
+    ohno::guild_cache* const m_cache_guild;
+    ohno::stream_parser m_parser;
+    frame_stream_status m_status;
+    std::vector< context_type > m_contexts;
+    std::string m_key;
+    opcode_type m_opcode;
+    std::optional< uint32_t > m_sequence;
+    std::string m_event_name;
+    event_type m_event;
+    snowflake_type m_guild_id;
+    bool m_is_guild_replaced;
+    std::string m_session_id;
+    std::string m_resume_gateway_url;
+    item_type m_item;
+    std::vector< item_type > m_items_pending;
+    std::size_t m_size;
+}; // class qyzk::ohno::frame_stream
+
+} // namespace qyzk::ohno
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef __QYZK_OHNO_FRAME_TEMPLATE_H__
+#define __QYZK_OHNO_FRAME_TEMPLATE_H__
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "./opcode.h"
+
+namespace qyzk::ohno
+{
+
+/*
+ * a json command frame as constant text around holes, only the fields are rendered per frame
+ * there is one piece more than there are holes, fields go between neighbouring pieces
+ */
+template <std::size_t count_piece>
+struct frame_template
+{
+    std::array< std::string_view, count_piece > pieces;
+};
+
+// the opcodes are spelled out in the templates below
+static_assert(static_cast< uint32_t >(opcode_type::heartbeat) == 1);
+static_assert(static_cast< uint32_t >(opcode_type::identify) == 2);
+static_assert(static_cast< uint32_t >(opcode_type::resume) == 6);
+
+// sequence, or null before the first dispatch
+inline constexpr frame_template< 2 > heartbeat_frame {
+    {
+        R"({"op":1,"d":)",
+        R"(})",
+    },
+};
+
+// token, intents, large threshold, guild subscriptions
+inline constexpr frame_template< 5 > identify_frame {
+    {
+        R"({"op":2,"d":{"token":")",
+        R"(","properties":{"$os":"Archlinux","$browser":"oh no bot","$device":"oh no bot"},)"
+        R"("presence":{"status":"online","afk":"false"},"intents":)",
+        R"(,"large_threshold":)",
+        R"(,"guild_subscriptions":)",
+        R"(}})",
+    },
+};
+
+// token, session id, sequence
+inline constexpr frame_template< 4 > resume_frame {
+    {
+        R"({"op":6,"d":{"token":")",
+        R"(","session_id":")",
+        R"(","seq":)",
+        R"(}})",
+    },
+};
+
+inline auto append_field(
+    std::string& output,
+    uint32_t const value)
+    -> void
+{
+    std::array< char, 10 > digits;
+    auto const result = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+    output.append(digits.data(), result.ptr);
+}
+
+inline auto append_field(
+    std::string& output,
+    bool const value)
+    -> void
+{
+    output.append(value ? "true" : "false");
+}
+
+inline auto append_field(
+    std::string& output,
+    std::nullptr_t)
+    -> void
+{
+    output.append("null");
+}
+
+// would be taken for a bool, pass a string_view
+auto append_field(
+    std::string& output,
+    char const* value)
+    -> void = delete;
+
+// the body of a json string, the quotes are part of the template
+inline auto append_field(
+    std::string& output,
+    std::string_view const value)
+    -> void
+{
+    constexpr std::string_view digits_hex = "0123456789abcdef";
+
+    for (auto const letter : value)
+    {
+        if (letter == '"' || letter == '\\')
+        {
+            output.push_back('\\');
+            output.push_back(letter);
+        }
+        else if (static_cast< unsigned char >(letter) < 0x20)
+        {
+            output.append("\\u00");
+            output.push_back(digits_hex[static_cast< unsigned char >(letter) >> 4]);
+            output.push_back(digits_hex[static_cast< unsigned char >(letter) & 0xf]);
+        }
+        else
+        {
+            output.push_back(letter);
+        }
+    }
+}
+
+/*
+ * renders a frame into output, replacing what was there
+ * once output has grown to the frame's size this does not allocate
+ */
+template <std::size_t count_piece, typename... field_types>
+auto render_frame(
+    frame_template< count_piece > const& frame,
+    std::string& output,
+    field_types const&... fields)
+    -> void
+{
+    static_assert(sizeof...(fields) + 1 == count_piece, "one field for every hole");
+
+    output.clear();
+    output.append(frame.pieces[0]);
+
+    std::size_t index = 0;
+    ((append_field(output, fields), output.append(frame.pieces[++index])), ...);
+}
+
+} // namespace qyzk::ohno
+
+#endif
@@ -0,0 +1,39 @@
+#include <utility>
+
+#include "./gateway_connection.h"
+
+namespace qyzk::ohno
+{
+
+gateway_connection::gateway_connection(
+    uint64_t const id,
+    std::unique_ptr< ws_stream_type > stream,
+    strand_type const& strand,
+    ohno::buffer_pool& pool,
+    gateway_writer_counters& counters)
+    : id(id)
+    , stream(std::move(stream))
+    , writer(*this->stream, strand, counters)
+    , inflater()
+    , size_compressed_done(0)
+    , buffer_event(pool.acquire())
+    , buffer_inflated(pool.acquire())
+    , stream_frame()
+    , size_streamed(0)
+{
+}
+
+auto make_gateway_connection(
+    uint64_t const id,
+    std::unique_ptr< ws_stream_type > stream,
+    gateway_connection::strand_type const& strand,
+    ohno::buffer_pool& pool,
+    gateway_writer_counters& counters)
+    -> std::shared_ptr< gateway_connection >
+{
+    auto connection = std::make_shared< gateway_connection >(id, std::move(stream), strand, pool, counters);
+    connection->writer.set_owner(connection);
+    return connection;
+}
+
+} // namespace qyzk::ohno
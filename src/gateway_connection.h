@@ -0,0 +1,57 @@
+#ifndef __QYZK_OHNO_GATEWAY_CONNECTION_H__
+#define __QYZK_OHNO_GATEWAY_CONNECTION_H__
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "./buffer_pool.h"
+#include "./frame_stream.h"
+#include "./gateway_writer.h"
+#include "./http_request.h"
+#include "./inflater.h"
+
+namespace qyzk::ohno
+{
+
+/*
+ * one websocket connection to the gateway and the state of what is being read from it
+ * the bot drops it for a new one on reconnecting, handlers still pending on it keep it alive until they're through
+ */
+struct gateway_connection
+{
+    using strand_type = boost::asio::strand< boost::asio::io_context::executor_type >;
+
+    gateway_connection(
+        uint64_t const id,
+        std::unique_ptr< ws_stream_type > stream,
+        strand_type const& strand,
+        ohno::buffer_pool& pool,
+        gateway_writer_counters& counters);
+
+    gateway_connection(gateway_connection const&) = delete;
+    auto operator=(gateway_connection const&) -> gateway_connection& = delete;
+
+    uint64_t const id; // counts up with every connection the bot makes, for the logs
+    std::unique_ptr< ws_stream_type > const stream;
+    ohno::gateway_writer writer;
+    ohno::inflater inflater; // zlib-stream compression spans the whole connection
+    uint64_t size_compressed_done; // the inflater's compressed total when the last payload was complete
+    pooled_buffer buffer_event;
+    pooled_buffer buffer_inflated;
+    std::optional< ohno::frame_stream > stream_frame; // the frame being parsed as it arrives, if any
+    std::size_t size_streamed;
+};
+
+// the writer's pending handlers hold on to the connection they're writing to
+auto make_gateway_connection(
+    uint64_t const id,
+    std::unique_ptr< ws_stream_type > stream,
+    gateway_connection::strand_type const& strand,
+    ohno::buffer_pool& pool,
+    gateway_writer_counters& counters)
+    -> std::shared_ptr< gateway_connection >;
+
+} // namespace qyzk::ohno
+
+#endif
@@ -0,0 +1,277 @@
+#include <utility>
+
+#include <boost/log/trivial.hpp>
+
+#include "./gateway_writer.h"
+
+namespace
+{
+
+// more than are ever queued at once in practice
+constexpr std::size_t count_frame_idle_max = 8;
+
+// the gateway drops connections sending more than this many commands a minute
+constexpr uint32_t count_command_period = 120;
+constexpr auto period_command = std::chrono::seconds(60);
+
+// kept below the limit to leave room for clock skew with the gateway's own window
+constexpr uint32_t count_command_headroom = 10;
+
+// a full bucket refills as many tokens again within a period, so together they stay under the limit by the headroom
+constexpr uint32_t capacity_bucket = (count_command_period - count_command_headroom) / 2;
+
+// left for heartbeats, which go out every forty seconds or so and when the gateway asks for one
+constexpr uint32_t count_reserved_heartbeat = 4;
+
+} // namespace
+
+namespace qyzk::ohno
+{
+
+gateway_writer::gateway_writer(
+    ws_stream_type& stream,
+    strand_type const& strand,
+    gateway_writer_counters& counters)
+    : m_stream(stream)
+    , m_strand(strand)
+    , m_counters(counters)
+    , m_owner()
+    , m_queue_heartbeat()
+    , m_queue_normal()
+    , m_frames_idle()
+    , m_entry_writing()
+    , m_reason_close()
+    , m_handler_close()
+    , m_bucket(capacity_bucket, period_command, token_bucket::clock_type::now())
+    , m_timer_limit(strand)
+    , m_is_writing(false)
+    , m_is_waiting(false)
+    , m_is_closing(false)
+{
+    // release must not allocate
+    m_frames_idle.reserve(count_frame_idle_max);
+}
+
+auto gateway_writer::set_owner(std::weak_ptr< void > owner) noexcept -> void
+{
+    m_owner = std::move(owner);
+}
+
+auto gateway_writer::acquire_frame(void) -> std::string
+{
+    if (m_frames_idle.empty())
+        return {};
+
+    auto frame = std::move(m_frames_idle.back());
+    m_frames_idle.pop_back();
+    return frame;
+}
+
+auto gateway_writer::write(
+    std::string frame,
+    write_priority_type const priority,
+    handler_type handler)
+    -> void
+{
+    if (m_is_closing)
+    {
+        complete(handler, boost::asio::error::operation_aborted);
+        return;
+    }
+
+    auto& queue = priority == write_priority_type::heartbeat ? m_queue_heartbeat : m_queue_normal;
+    if (priority == write_priority_type::normal && queue.size() >= count_command_period)
+    {
+        BOOST_LOG_TRIVIAL(warning) << "gateway write queue is full, rejecting command";
+        ++m_counters.count_rejected;
+        complete(handler, boost::asio::error::no_buffer_space);
+        return;
+    }
+
+    queue.push_back({ std::move(frame), std::move(handler) });
+    write_next();
+}
+
+auto gateway_writer::close(
+    boost::beast::websocket::close_reason const& reason,
+    handler_type handler)
+    -> void
+{
+    if (m_is_closing)
+    {
+        complete(handler, boost::asio::error::operation_aborted);
+        return;
+    }
+
+    m_is_closing = true;
+    m_reason_close = reason;
+    m_handler_close = std::move(handler);
+    write_next();
+}
+
+auto gateway_writer::cancel(void) -> void
+{
+    fail_all(boost::asio::error::operation_aborted);
+}
+
+auto gateway_writer::get_depth(void) const noexcept -> std::size_t
+{
+    return m_queue_heartbeat.size() + m_queue_normal.size();
+}
+
+auto gateway_writer::write_next(void) -> void
+{
+    if (m_is_writing)
+        return;
+
+    // heartbeats may use up the bucket, everything else leaves the reserve alone
+    auto const is_heartbeat = !m_queue_heartbeat.empty();
+    auto& queue = is_heartbeat ? m_queue_heartbeat : m_queue_normal;
+    if (!queue.empty())
+    {
+        auto const now = token_bucket::clock_type::now();
+        auto const reserve = is_heartbeat ? 0 : count_reserved_heartbeat;
+        if (!m_bucket.try_take(now, reserve))
+        {
+            wait(m_bucket.get_wait(now, reserve));
+            return;
+        }
+
+        m_entry_writing = std::move(queue.front());
+        queue.pop_front();
+        m_is_writing = true;
+        m_stream.async_write(
+            boost::asio::buffer(m_entry_writing->frame),
+            boost::asio::bind_executor(
+                m_strand,
+                [this, owner = m_owner.lock()](boost::beast::error_code const& error, std::size_t const bytes_written)
+                {
+                    handle_write(error, bytes_written);
+                }));
+        return;
+    }
+
+    if (m_reason_close)
+    {
+        auto const reason = *std::exchange(m_reason_close, std::nullopt);
+        m_is_writing = true;
+        m_stream.async_close(
+            reason,
+            boost::asio::bind_executor(
+                m_strand,
+                [this, owner = m_owner.lock()](boost::beast::error_code const& error)
+                {
+                    handle_close(error);
+                }));
+    }
+}
+
+auto gateway_writer::wait(token_bucket::clock_type::duration const duration) -> void
+{
+    // a heartbeat may still get through in the meantime, the timer only wakes the queue up
+    if (m_is_waiting)
+        return;
+
+    BOOST_LOG_TRIVIAL(debug)
+        << "gateway command budget is used up, waiting "
+        << std::chrono::duration_cast< std::chrono::milliseconds >(duration).count() << "ms";
+    ++m_counters.count_waited;
+    m_is_waiting = true;
+    m_timer_limit.expires_after(duration);
+    m_timer_limit.async_wait(
+        boost::asio::bind_executor(
+            m_strand,
+            [this, owner = m_owner.lock()](boost::beast::error_code const& error)
+            {
+                handle_wait(error);
+            }));
+}
+
+auto gateway_writer::handle_wait(boost::beast::error_code const& error) -> void
+{
+    m_is_waiting = false;
+    if (error)
+        return;
+    write_next();
+}
+
+auto gateway_writer::handle_write(
+    boost::beast::error_code const& error,
+    std::size_t const bytes_written)
+    -> void
+{
+    m_is_writing = false;
+    auto entry = std::move(*m_entry_writing);
+    m_entry_writing.reset();
+    release_frame(std::move(entry.frame));
+
+    if (error)
+    {
+        // the connection is gone, nothing behind this frame makes it out either
+        complete(entry.handler, error);
+        fail_all(error);
+        return;
+    }
+
+    ++m_counters.count_written;
+    BOOST_LOG_TRIVIAL(trace) << "wrote " << bytes_written << " bytes to gateway, " << get_depth() << " frames queued";
+    complete(entry.handler, error);
+    write_next();
+}
+
+auto gateway_writer::handle_close(boost::beast::error_code const& error) -> void
+{
+    m_is_writing = false;
+    complete(std::exchange(m_handler_close, nullptr), error);
+}
+
+auto gateway_writer::fail_all(boost::beast::error_code const& error) -> void
+{
+    m_timer_limit.cancel();
+
+    auto queue_heartbeat = std::exchange(m_queue_heartbeat, {});
+    auto queue_normal = std::exchange(m_queue_normal, {});
+    for (auto const& entry : queue_heartbeat)
+        complete(entry.handler, error);
+    for (auto const& entry : queue_normal)
+        complete(entry.handler, error);
+
+    if (m_reason_close)
+    {
+        m_reason_close.reset();
+        complete(std::exchange(m_handler_close, nullptr), error);
+    }
+    m_is_closing = true;
+}
+
+auto gateway_writer::release_frame(std::string frame) noexcept -> void
+{
+    if (m_frames_idle.size() >= count_frame_idle_max)
+        return;
+
+    frame.clear();
+    m_frames_idle.push_back(std::move(frame));
+}
+
+auto gateway_writer::complete(
+    handler_type const& handler,
+    boost::beast::error_code const& error)
+    -> void
+{
+    if (handler)
+    {
+        // never from inside write or close, the caller may not expect to be reentered
+        boost::asio::post(
+            m_strand,
+            [handler, error](void)
+            {
+                handler(error);
+            });
+    }
+    else if (error && error != boost::asio::error::operation_aborted)
+    {
+        BOOST_LOG_TRIVIAL(error) << "failed to write to gateway: " << error.message();
+    }
+}
+
+} // namespace qyzk::ohno
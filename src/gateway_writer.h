@@ -0,0 +1,118 @@
+#ifndef __QYZK_OHNO_GATEWAY_WRITER_H__
+#define __QYZK_OHNO_GATEWAY_WRITER_H__
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "./http_request.h"
+#include "./token_bucket.h"
+
+namespace qyzk::ohno
+{
+
+enum class write_priority_type
+{
+    heartbeat, // goes ahead of everything queued, a late heartbeat gets the connection dropped
+    normal,
+};
+
+struct gateway_writer_statistics
+{
+    uint64_t count_written;
+    uint64_t count_waited; // times the rate limit held the queue back
+    uint64_t count_rejected; // frames refused because a full period's worth was already queued
+};
+
+// outlives the writers, the counts carry over from one connection to the next
+struct gateway_writer_counters
+{
+    std::atomic< uint64_t > count_written { 0 };
+    std::atomic< uint64_t > count_waited { 0 };
+    std::atomic< uint64_t > count_rejected { 0 };
+};
+
+/*
+ * the one writer of a gateway connection, frames are queued and written one at a time without blocking
+ * writes are rate limited to the gateway's command budget, with some of it kept for heartbeats
+ * every member has to be called on the strand the connection's handlers run on
+ */
+class gateway_writer
+{
+public:
+    using strand_type = boost::asio::strand< boost::asio::io_context::executor_type >;
+    using handler_type = std::function< void(boost::beast::error_code const& error) >;
+
+    gateway_writer(
+        ws_stream_type& stream,
+        strand_type const& strand,
+        gateway_writer_counters& counters);
+
+    gateway_writer(gateway_writer const&) = delete;
+    auto operator=(gateway_writer const&) -> gateway_writer& = delete;
+
+    // kept alive by every operation still pending on the stream
+    auto set_owner(std::weak_ptr< void > owner) noexcept -> void;
+    // an empty string to render a frame into, its memory comes back here after the frame is written
+    auto acquire_frame(void) -> std::string;
+    // the handler is called once the frame is written or has failed, writes after close fail right away
+    auto write(
+        std::string frame,
+        write_priority_type const priority,
+        handler_type handler = nullptr)
+        -> void;
+    // closes the connection after everything already queued has been written
+    auto close(
+        boost::beast::websocket::close_reason const& reason,
+        handler_type handler = nullptr)
+        -> void;
+    // fails everything queued and stops waiting on the rate limit, for a connection dropped without closing
+    auto cancel(void) -> void;
+    auto get_depth(void) const noexcept -> std::size_t;
+
+private:
+    struct entry
+    {
+        std::string frame;
+        handler_type handler;
+    };
+
+    auto write_next(void) -> void;
+    auto wait(token_bucket::clock_type::duration const duration) -> void;
+    auto handle_wait(boost::beast::error_code const& error) -> void;
+    auto handle_write(
+        boost::beast::error_code const& error,
+        std::size_t const bytes_written)
+        -> void;
+    auto handle_close(boost::beast::error_code const& error) -> void;
+    auto fail_all(boost::beast::error_code const& error) -> void;
+    auto release_frame(std::string frame) noexcept -> void;
+    auto complete(
+        handler_type const& handler,
+        boost::beast::error_code const& error)
+        -> void;
+
+    ws_stream_type& m_stream;
+    strand_type m_strand;
+    gateway_writer_counters& m_counters;
+    std::weak_ptr< void > m_owner;
+    std::deque< entry > m_queue_heartbeat;
+    std::deque< entry > m_queue_normal;
+    std::vector< std::string > m_frames_idle;
+    std::optional< entry > m_entry_writing;
+    std::optional< boost::beast::websocket::close_reason > m_reason_close;
+    handler_type m_handler_close;
+    ohno::token_bucket m_bucket;
+    boost::asio::steady_timer m_timer_limit;
+    bool m_is_writing;
+    bool m_is_waiting;
+    bool m_is_closing;
+}; // class qyzk::ohno::gateway_writer
+
+} // namespace qyzk::ohno
+
+#endif
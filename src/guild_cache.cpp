@@ -0,0 +1,147 @@
+#include "./guild_cache.h"
+
+namespace
+{
+
+// a large guild's create lists only part of its members anyway, the rest is never worth the memory
+constexpr std::size_t count_member_max = 1000;
+
+template <typename map_type>
+auto find_value(
+    map_type const& map,
+    qyzk::ohno::snowflake_type const id)
+    -> std::optional< typename map_type::mapped_type >
+{
+    auto const found = map.find(id);
+    if (found == map.end())
+        return std::nullopt;
+    return found->second;
+}
+
+} // namespace
+
+namespace qyzk::ohno
+{
+
+auto guild_cache::set_channel(
+    snowflake_type const guild_id,
+    guild_channel channel)
+    -> void
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    auto const id = channel.id;
+    m_guilds[guild_id].channels.insert_or_assign(id, std::move(channel));
+}
+
+auto guild_cache::set_role(
+    snowflake_type const guild_id,
+    guild_role role)
+    -> void
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    auto const id = role.id;
+    m_guilds[guild_id].roles.insert_or_assign(id, std::move(role));
+}
+
+auto guild_cache::set_member(
+    snowflake_type const guild_id,
+    guild_member member)
+    -> void
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    auto const id = member.user_id;
+    auto& members = m_guilds[guild_id].members;
+    if (members.size() >= count_member_max && members.find(id) == members.end())
+        return;
+    members.insert_or_assign(id, std::move(member));
+}
+
+auto guild_cache::remove_guild(snowflake_type const guild_id) -> void
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    m_guilds.erase(guild_id);
+}
+
+auto guild_cache::remove_channel(
+    snowflake_type const guild_id,
+    snowflake_type const channel_id)
+    -> void
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    auto const guild = m_guilds.find(guild_id);
+    if (guild != m_guilds.end())
+        guild->second.channels.erase(channel_id);
+}
+
+auto guild_cache::remove_role(
+    snowflake_type const guild_id,
+    snowflake_type const role_id)
+    -> void
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    auto const guild = m_guilds.find(guild_id);
+    if (guild != m_guilds.end())
+        guild->second.roles.erase(role_id);
+}
+
+auto guild_cache::remove_member(
+    snowflake_type const guild_id,
+    snowflake_type const user_id)
+    -> void
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    auto const guild = m_guilds.find(guild_id);
+    if (guild != m_guilds.end())
+        guild->second.members.erase(user_id);
+}
+
+auto guild_cache::get_channel(
+    snowflake_type const guild_id,
+    snowflake_type const channel_id) const
+    -> std::optional< guild_channel >
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    auto const guild = m_guilds.find(guild_id);
+    if (guild == m_guilds.end())
+        return std::nullopt;
+    return find_value(guild->second.channels, channel_id);
+}
+
+auto guild_cache::get_role(
+    snowflake_type const guild_id,
+    snowflake_type const role_id) const
+    -> std::optional< guild_role >
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    auto const guild = m_guilds.find(guild_id);
+    if (guild == m_guilds.end())
+        return std::nullopt;
+    return find_value(guild->second.roles, role_id);
+}
+
+auto guild_cache::get_member(
+    snowflake_type const guild_id,
+    snowflake_type const user_id) const
+    -> std::optional< guild_member >
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    auto const guild = m_guilds.find(guild_id);
+    if (guild == m_guilds.end())
+        return std::nullopt;
+    return find_value(guild->second.members, user_id);
+}
+
+auto guild_cache::get_counts(snowflake_type const guild_id) const -> guild_cache_counts
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    auto const guild = m_guilds.find(guild_id);
+    if (guild == m_guilds.end())
+        return { 0, 0, 0 };
+    return {
+        guild->second.channels.size(),
+        guild->second.roles.size(),
+        guild->second.members.size(),
+    };
+}
+
+} // namespace qyzk::ohno
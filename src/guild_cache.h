@@ -0,0 +1,102 @@
+#ifndef __QYZK_OHNO_GUILD_CACHE_H__
+#define __QYZK_OHNO_GUILD_CACHE_H__
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "./event.h"
+
+namespace qyzk::ohno
+{
+
+struct guild_channel
+{
+    snowflake_type id;
+    std::string name;
+};
+
+struct guild_role
+{
+    snowflake_type id;
+    std::string name;
+};
+
+struct guild_member
+{
+    snowflake_type user_id;
+    std::string username;
+};
+
+struct guild_cache_counts
+{
+    std::size_t channels;
+    std::size_t roles;
+    std::size_t members;
+};
+
+/*
+ * what the gateway has told about each guild, filled while guild creates are still arriving
+ * a guild create replaces whatever was cached for its guild, delete events evict, members are capped per guild
+ * safe to share between threads, lookups hand out copies
+ */
+class guild_cache
+{
+public:
+    auto set_channel(
+        snowflake_type const guild_id,
+        guild_channel channel)
+        -> void;
+    auto set_role(
+        snowflake_type const guild_id,
+        guild_role role)
+        -> void;
+    auto set_member(
+        snowflake_type const guild_id,
+        guild_member member)
+        -> void;
+
+    auto remove_guild(snowflake_type const guild_id) -> void;
+    auto remove_channel(
+        snowflake_type const guild_id,
+        snowflake_type const channel_id)
+        -> void;
+    auto remove_role(
+        snowflake_type const guild_id,
+        snowflake_type const role_id)
+        -> void;
+    auto remove_member(
+        snowflake_type const guild_id,
+        snowflake_type const user_id)
+        -> void;
+
+    auto get_channel(
+        snowflake_type const guild_id,
+        snowflake_type const channel_id) const
+        -> std::optional< guild_channel >;
+    auto get_role(
+        snowflake_type const guild_id,
+        snowflake_type const role_id) const
+        -> std::optional< guild_role >;
+    auto get_member(
+        snowflake_type const guild_id,
+        snowflake_type const user_id) const
+        -> std::optional< guild_member >;
+    auto get_counts(snowflake_type const guild_id) const -> guild_cache_counts;
+
+private:
+    struct guild_entry
+    {
+        std::unordered_map< snowflake_type, guild_channel > channels;
+        std::unordered_map< snowflake_type, guild_role > roles;
+        std::unordered_map< snowflake_type, guild_member > members;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map< snowflake_type, guild_entry > m_guilds;
+}; // class qyzk::ohno::guild_cache
+
+} // namespace qyzk::ohno
+
+#endif
@@ -0,0 +1,61 @@
+#include <algorithm>
+
+#include "./heartbeat_tracker.h"
+
+namespace qyzk::ohno
+{
+
+heartbeat_tracker::heartbeat_tracker(void)
+    : m_mutex()
+    , m_time_sent()
+    , m_statistics()
+{
+    m_statistics.rtt_min = std::chrono::milliseconds::max();
+}
+
+auto heartbeat_tracker::try_send(clock_type::time_point const now) -> bool
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    if (m_time_sent)
+    {
+        ++m_statistics.count_missed;
+        return false;
+    }
+
+    m_time_sent = now;
+    ++m_statistics.count_sent;
+    return true;
+}
+
+auto heartbeat_tracker::acknowledge(clock_type::time_point const now) -> std::optional< std::chrono::milliseconds >
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    if (!m_time_sent)
+        return std::nullopt;
+
+    auto const rtt = std::chrono::duration_cast< std::chrono::milliseconds >(now - *m_time_sent);
+    m_time_sent.reset();
+
+    auto const bucket = std::lower_bound(heartbeat_rtt_buckets.begin(), heartbeat_rtt_buckets.end(), static_cast< uint64_t >(rtt.count()));
+    ++m_statistics.count_rtt[static_cast< std::size_t >(bucket - heartbeat_rtt_buckets.begin())];
+    ++m_statistics.count_acked;
+    m_statistics.rtt_last = rtt;
+    m_statistics.rtt_min = std::min(m_statistics.rtt_min, rtt);
+    m_statistics.rtt_max = std::max(m_statistics.rtt_max, rtt);
+    m_statistics.rtt_total += rtt;
+    return rtt;
+}
+
+auto heartbeat_tracker::reset(void) -> void
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    m_time_sent.reset();
+}
+
+auto heartbeat_tracker::get_statistics(void) const -> heartbeat_statistics
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    return m_statistics;
+}
+
+} // namespace qyzk::ohno
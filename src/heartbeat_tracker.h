@@ -0,0 +1,65 @@
+#ifndef __QYZK_OHNO_HEARTBEAT_TRACKER_H__
+#define __QYZK_OHNO_HEARTBEAT_TRACKER_H__
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+namespace qyzk::ohno
+{
+
+// upper bounds of the round trip time buckets, in milliseconds
+inline constexpr std::array< uint32_t, 8 > heartbeat_rtt_buckets {
+    25,
+    50,
+    100,
+    200,
+    400,
+    800,
+    1600,
+    3200,
+};
+
+struct heartbeat_statistics
+{
+    // round trips counted by bucket, the last one is for anything slower than the slowest bucket
+    std::array< uint64_t, heartbeat_rtt_buckets.size() + 1 > count_rtt;
+    std::chrono::milliseconds rtt_last;
+    std::chrono::milliseconds rtt_min;
+    std::chrono::milliseconds rtt_max;
+    std::chrono::milliseconds rtt_total;
+    uint64_t count_sent;
+    uint64_t count_acked;
+    uint64_t count_missed;
+};
+
+/*
+ * matches heartbeats with their acks, a heartbeat due while the last one is unacked means a zombie connection
+ * safe to read from any thread, so statistics can be collected off the gateway's strand
+ */
+class heartbeat_tracker
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    heartbeat_tracker(void);
+
+    // false when the previous heartbeat was never acked, nothing is recorded then
+    auto try_send(clock_type::time_point const now) -> bool;
+    // the round trip of the heartbeat acked, or nothing for an ack nobody waited for
+    auto acknowledge(clock_type::time_point const now) -> std::optional< std::chrono::milliseconds >;
+    // forgets the heartbeat in flight, for a fresh connection
+    auto reset(void) -> void;
+    auto get_statistics(void) const -> heartbeat_statistics;
+
+private:
+    mutable std::mutex m_mutex;
+    std::optional< clock_type::time_point > m_time_sent;
+    heartbeat_statistics m_statistics;
+}; // class qyzk::ohno::heartbeat_tracker
+
+} // namespace qyzk::ohno
+
+#endif
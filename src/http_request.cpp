@@ -4,6 +4,7 @@
 #include <boost/log/trivial.hpp>
 
 #include "./http_request.h"
+#include "./tls_session_cache.h"
 
 using namespace boost::asio;
 using namespace boost::beast;
@@ -12,6 +13,9 @@ using json = nlohmann::json;
 namespace
 {
 
+// for getting through tcp and tls, the websocket handshake has a timeout of its own
+constexpr auto timeout_connect = std::chrono::seconds(30);
+
 class ssl_sni_setting_error : public std::exception
 {
 public:
@@ -21,15 +25,6 @@ public:
     }
 };
 
-class hostname_resolve_error : public std::exception
-{
-public:
-    virtual auto what(void) const noexcept -> const char* override
-    {
-        return "failed to resolve hostname";
-    }
-};
-
 class http_connection_error : public std::exception
 {
 public:
@@ -84,35 +79,6 @@ auto set_sni(qyzk::ohno::stream_type& stream, std::string const& hostname) -> vo
     }
 }
 
-auto secure_connect(
-    io_context& context_io,
-    ssl::context& context_ssl,
-    std::string const& hostname,
-    qyzk::ohno::hosts_type const& hosts)
-    -> qyzk::ohno::stream_type
-{
-    qyzk::ohno::stream_type stream(context_io, context_ssl);
-    set_sni(stream, hostname);
-
-    error_code error;
-    get_lowest_layer(stream).connect(hosts, error);
-    if (error)
-    {
-        BOOST_LOG_TRIVIAL(error) << "failed to connect to host: " << error.message();
-        throw http_connection_error();
-    }
-
-    stream.handshake(ssl::stream_base::client, error);
-    if (error)
-    {
-        BOOST_LOG_TRIVIAL(error) << "failed to establish secure connection: " << error.message();
-        get_lowest_layer(stream).close();
-        throw ssl_handshake_error();
-    }
-
-    return stream;
-}
-
 auto send_request(qyzk::ohno::stream_type& stream, http::request< http::string_body > const& request) -> json
 {
     error_code error;
@@ -178,32 +144,179 @@ auto get_hostname(std::string const& url)
     return url.substr(index);
 }
 
+// connecting to the gateway step by step, the operation keeps itself alive through the handlers it passes on
+class gateway_connect_operation : public std::enable_shared_from_this< gateway_connect_operation >
+{
+public:
+    gateway_connect_operation(
+        strand< io_context::executor_type > const& strand,
+        ssl::context& context_ssl,
+        qyzk::ohno::resolver_cache& resolver,
+        std::string hostname,
+        std::string option,
+        qyzk::ohno::gateway_connect_handler_type handler)
+        : m_strand(strand)
+        , m_resolver(resolver)
+        , m_stream(std::make_unique< qyzk::ohno::ws_stream_type >(strand, context_ssl))
+        , m_hostname(std::move(hostname))
+        , m_option(std::move(option))
+        , m_handler(std::move(handler))
+    {
+    }
+
+    auto start(void) -> void
+    {
+        if (SSL_set_tlsext_host_name(m_stream->next_layer().native_handle(), m_hostname.c_str()) != 1)
+        {
+            fail(boost::asio::error::invalid_argument, "failed to set ssl sni");
+            return;
+        }
+        qyzk::ohno::tls_session_cache::resume(m_stream->next_layer().native_handle());
+
+        m_resolver.async_resolve(
+            m_hostname,
+            "https",
+            [self = shared_from_this()](error_code const& error, ip::tcp::resolver::results_type const& hosts)
+            {
+                // the cache answers on any io thread, the stream is only touched on its strand
+                boost::asio::dispatch(
+                    self->m_strand,
+                    [self, error, hosts](void)
+                    {
+                        self->handle_resolve(error, hosts);
+                    });
+            });
+    }
+
+private:
+    auto handle_resolve(
+        error_code const& error,
+        ip::tcp::resolver::results_type const& hosts)
+        -> void
+    {
+        if (error)
+        {
+            fail(error, "failed to resolve gateway host");
+            return;
+        }
+
+        get_lowest_layer(*m_stream).expires_after(timeout_connect);
+        get_lowest_layer(*m_stream).async_connect(
+            hosts,
+            [self = shared_from_this()](error_code const& error, ip::tcp::endpoint const&)
+            {
+                self->handle_connect(error);
+            });
+    }
+
+    auto handle_connect(error_code const& error) -> void
+    {
+        if (error)
+        {
+            fail(error, "failed to connect to gateway host");
+            return;
+        }
+
+        m_stream->next_layer().async_handshake(
+            ssl::stream_base::client,
+            [self = shared_from_this()](error_code const& error)
+            {
+                self->handle_handshake_tls(error);
+            });
+    }
+
+    auto handle_handshake_tls(error_code const& error) -> void
+    {
+        if (error)
+        {
+            fail(error, "failed to establish secure connection with gateway");
+            return;
+        }
+        qyzk::ohno::tls_session_cache::record(m_stream->next_layer().native_handle());
+
+        // the websocket layer keeps its own timeouts from here on
+        get_lowest_layer(*m_stream).expires_never();
+        m_stream->set_option(websocket::stream_base::timeout::suggested(role_type::client));
+        m_stream->async_handshake(
+            m_hostname,
+            m_option,
+            [self = shared_from_this()](error_code const& error)
+            {
+                self->handle_handshake_websocket(error);
+            });
+    }
+
+    auto handle_handshake_websocket(error_code const& error) -> void
+    {
+        if (error)
+        {
+            fail(error, "failed to handshake on websocket layer with discord gateway");
+            return;
+        }
+
+        m_handler(error, std::move(m_stream));
+    }
+
+    auto fail(
+        error_code const& error,
+        char const* const message)
+        -> void
+    {
+        BOOST_LOG_TRIVIAL(error) << message << ": " << error.message();
+        m_handler(error, nullptr);
+    }
+
+    strand< io_context::executor_type > const m_strand;
+    qyzk::ohno::resolver_cache& m_resolver;
+    std::unique_ptr< qyzk::ohno::ws_stream_type > m_stream;
+    std::string const m_hostname;
+    std::string const m_option;
+    qyzk::ohno::gateway_connect_handler_type const m_handler;
+};
+
 } // namespace
 
 namespace qyzk::ohno
 {
 
-auto resolve(std::string const& hostname, std::string const& service) -> hosts_type
+auto secure_connect(
+    io_context& context_io,
+    ssl::context& context_ssl,
+    std::string const& hostname,
+    hosts_type const& hosts)
+    -> stream_type
 {
-    io_context context_io;
-    ip::tcp::resolver resolver(context_io);
+    stream_type stream(context_io, context_ssl);
+    set_sni(stream, hostname);
+    qyzk::ohno::tls_session_cache::resume(stream.native_handle());
+
     error_code error;
-    auto hosts = resolver.resolve(hostname, service, error);
+    get_lowest_layer(stream).connect(hosts, error);
     if (error)
     {
-        BOOST_LOG_TRIVIAL(error) << "failed to resolve host: " << error.message();
-        throw hostname_resolve_error();
+        BOOST_LOG_TRIVIAL(error) << "failed to connect to host: " << error.message();
+        throw http_connection_error();
+    }
+
+    stream.handshake(ssl::stream_base::client, error);
+    if (error)
+    {
+        BOOST_LOG_TRIVIAL(error) << "failed to establish secure connection: " << error.message();
+        get_lowest_layer(stream).close();
+        throw ssl_handshake_error();
     }
-    return hosts;
+
+    qyzk::ohno::tls_session_cache::record(stream.native_handle());
+    return stream;
 }
 
 auto get_gateway_bot(
     ohno::config const& config,
+    ssl::context& context_ssl,
     hosts_type const& hosts)
     -> get_gateway_bot_result
 {
     io_context context_io;
-    ssl::context context_ssl(ssl::context::tlsv12_client);
 
     auto stream = secure_connect(
         context_io,
@@ -242,139 +355,21 @@ auto get_gateway_bot(
     return result;
 }
 
-auto connect_to_gateway(
-    boost::asio::io_context& context_io,
+auto async_connect_to_gateway(
+    boost::asio::strand< boost::asio::io_context::executor_type > const& strand,
     boost::asio::ssl::context& context_ssl,
+    ohno::resolver_cache& resolver,
     std::string const& url,
-    std::string const& option)
-    -> ws_stream_type
-{
-    const auto hostname = get_hostname(url);
-    auto hosts = resolve(hostname, "https");
-
-    ws_stream_type stream(secure_connect(context_io, context_ssl, hostname, hosts));
-
-    try
-    {
-        stream.handshake(hostname, option);
-    }
-    catch (std::exception const& error)
-    {
-        BOOST_LOG_TRIVIAL(error) << "failed to handshake on websocket layer with discord gateway: " << error.what();
-        throw;
-    }
-
-    return stream;
-}
-
-auto disconnect_from_gateway(stream_type& stream) -> void
-{
-    secure_disconnect(stream);
-}
-
-auto send_message(
-    ohno::config const& config,
-    hosts_type const& hosts,
-    std::string const channel,
-    std::string const message)
+    std::string const& option,
+    gateway_connect_handler_type handler)
     -> void
 {
-    io_context context_io;
-    ssl::context context_ssl(ssl::context::tlsv12_client);
-
-    json body;
-    body["content"] = message;
-
-    auto stream = secure_connect(
-        context_io,
-        context_ssl,
-        config.get_discord_hostname(),
-        hosts);
-
-    auto body_string = body.dump();
-
-    http::request< http::string_body > request {
-        http::verb::post,
-        config.get_http_api_location() + "/channels/" + channel + "/messages",
-        11,
-    };
-    request.set(http::field::host, config.get_discord_hostname());
-    request.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
-    request.set(http::field::authorization, "Bot " + config.get_token());
-    request.set(http::field::content_length, body_string.size());
-    request.set(http::field::content_type, "application/json");
-    request.body() = body_string;
-
-    json response;
-    try
-    {
-        response = send_request(stream, request);
-    }
-    catch (std::exception const& error)
-    {
-        secure_disconnect(stream);
-        throw;
-    }
-
-    secure_disconnect(stream);
+    std::make_shared< gateway_connect_operation >(strand, context_ssl, resolver, get_hostname(url), option, std::move(handler))->start();
 }
 
-auto kick(
-    ohno::config const& config,
-    hosts_type const& hosts,
-    std::string const guild,
-    std::string const id)
-    -> void
+auto disconnect_from_gateway(stream_type& stream) -> void
 {
-    io_context context_io;
-    ssl::context context_ssl(ssl::context::tlsv12_client);
-
-    auto stream = secure_connect(
-        context_io,
-        context_ssl,
-        config.get_discord_hostname(),
-        hosts);
-
-    http::request< http::string_body > request {
-        http::verb::delete_,
-        config.get_http_api_location() + "/guilds/" + guild + "/members/" + id,
-        11,
-    };
-    request.set(http::field::host, config.get_discord_hostname());
-    request.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
-    request.set(http::field::authorization, "Bot " + config.get_token());
-
-    send_request(stream, request);
     secure_disconnect(stream);
 }
 
-auto delete_message(
-    ohno::config const& config,
-    hosts_type const& hosts,
-    std::string const channel,
-    std::string const id)
-    -> void
-{
-    io_context context_io;
-    ssl::context context_ssl(ssl::context::tlsv12_client);
-
-    auto stream = secure_connect(
-        context_io,
-        context_ssl,
-        config.get_discord_hostname(),
-        hosts);
-
-    http::request< http::string_body > request {
-        http::verb::delete_,
-        config.get_http_api_location() + "/channels/" + channel + "/messages/" + id,
-        11,
-    };
-    request.set(http::field::host, config.get_discord_hostname());
-    request.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
-    request.set(http::field::authorization, "Bot " + config.get_token());
-
-    send_request(stream, request);
-
-    secure_disconnect(stream);
-}
 } // namespace qyzk::ohno
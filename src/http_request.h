@@ -1,6 +1,8 @@
 #ifndef __QYZK_OHNO_HTTP_REQUEST_H__
 #define __QYZK_OHNO_HTTP_REQUEST_H__
 
+#include <functional>
+#include <memory>
 #include <string>
 
 #include <boost/asio.hpp>
@@ -9,6 +11,7 @@
 #include <nlohmann/json.hpp>
 
 #include "./config.h"
+#include "./resolver_cache.h"
 
 namespace qyzk::ohno
 {
@@ -32,42 +35,35 @@ using hosts_type = decltype(
 using stream_type = boost::beast::ssl_stream< boost::beast::tcp_stream >;
 using ws_stream_type = boost::beast::websocket::stream< stream_type >;
 
-auto resolve(std::string const& hostname, std::string const& service) -> hosts_type;
+// connects and does the tls handshake, blocking, throws on failure
+auto secure_connect(
+    boost::asio::io_context& context_io,
+    boost::asio::ssl::context& context_ssl,
+    std::string const& hostname,
+    hosts_type const& hosts)
+    -> stream_type;
 
 auto get_gateway_bot(
     ohno::config const& config,
+    boost::asio::ssl::context& context_ssl,
     hosts_type const& hosts_resolved)
     -> get_gateway_bot_result;
 
-auto connect_to_gateway(
-    boost::asio::io_context& context_io,
+using gateway_connect_handler_type = std::function< void(
+    boost::beast::error_code const& error,
+    std::unique_ptr< ws_stream_type > stream) >;
+
+// resolves, connects and does both handshakes without blocking, the stream's handlers and the handler run on strand
+auto async_connect_to_gateway(
+    boost::asio::strand< boost::asio::io_context::executor_type > const& strand,
     boost::asio::ssl::context& context_ssl,
+    ohno::resolver_cache& resolver,
     std::string const& url,
-    std::string const& option)
-    -> ws_stream_type;
-
-auto disconnect_from_gateway(stream_type& stream) -> void;
-
-auto send_message(
-    ohno::config const& config,
-    hosts_type const& hosts,
-    std::string const channel,
-    std::string const message)
-    -> void;
-
-auto kick(
-    ohno::config const& config,
-    hosts_type const& hosts,
-    std::string const guild,
-    std::string const id)
+    std::string const& option,
+    gateway_connect_handler_type handler)
     -> void;
 
-auto delete_message(
-    ohno::config const& config,
-    hosts_type const& hosts,
-    std::string const channel,
-    std::string const id)
-    -> void;
+auto disconnect_from_gateway(stream_type& stream) -> void;
 
 } // namespace qyzk::ohno
 
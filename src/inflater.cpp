@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <exception>
+
+#include "./inflater.h"
+
+namespace
+{
+
+class inflate_init_error : public std::exception
+{
+public:
+    virtual auto what(void) const noexcept -> const char* override
+    {
+        return "failed to initialize zlib inflate stream";
+    }
+};
+
+class inflate_error : public std::exception
+{
+public:
+    virtual auto what(void) const noexcept -> const char* override
+    {
+        return "failed to inflate gateway payload";
+    }
+};
+
+// every complete zlib-stream payload ends with a Z_SYNC_FLUSH marker
+constexpr std::string_view zlib_suffix { "\x00\x00\xff\xff", 4 };
+
+// guild payloads compress well, so output chunks start at a few times the input
+constexpr std::size_t chunk_size_minimum = 16 * 1024;
+
+} // namespace
+
+namespace qyzk::ohno
+{
+
+inflater::inflater(void)
+    : m_stream()
+    , m_total_compressed(0)
+    , m_total_inflated(0)
+    , m_tail()
+    , m_size_tail(0)
+{
+    if (inflateInit(&m_stream) != Z_OK)
+        throw inflate_init_error();
+}
+
+inflater::~inflater(void)
+{
+    inflateEnd(&m_stream);
+}
+
+auto inflater::feed(
+    std::string_view const compressed,
+    boost::beast::flat_buffer& output)
+    -> bool
+{
+    m_stream.next_in = reinterpret_cast< Bytef* >(const_cast< char* >(compressed.data()));
+    m_stream.avail_in = static_cast< uInt >(compressed.size());
+
+    auto size_chunk = std::max(compressed.size() * 4, chunk_size_minimum);
+    do
+    {
+        auto const buffer = output.prepare(size_chunk);
+        m_stream.next_out = static_cast< Bytef* >(buffer.data());
+        m_stream.avail_out = static_cast< uInt >(buffer.size());
+
+        auto const result = ::inflate(&m_stream, Z_SYNC_FLUSH);
+        if (result != Z_OK && result != Z_BUF_ERROR)
+            throw inflate_error();
+
+        auto const size_inflated = buffer.size() - m_stream.avail_out;
+        output.commit(size_inflated);
+        m_total_inflated += size_inflated;
+        size_chunk *= 2;
+    }
+    while (m_stream.avail_in > 0 || m_stream.avail_out == 0);
+
+    m_total_compressed += compressed.size();
+
+    // shifted through the tail, a piece shorter than the suffix keeps the end of the one before it
+    for (auto const letter : compressed.substr(compressed.size() - std::min(compressed.size(), m_tail.size())))
+    {
+        if (m_size_tail == m_tail.size())
+            std::rotate(m_tail.begin(), m_tail.begin() + 1, m_tail.end());
+        else
+            ++m_size_tail;
+        m_tail[m_size_tail - 1] = letter;
+    }
+
+    return std::string_view(m_tail.data(), m_size_tail) == zlib_suffix;
+}
+
+auto inflater::get_compressed_size(void) const noexcept -> uint64_t
+{
+    return m_total_compressed;
+}
+
+auto inflater::get_inflated_size(void) const noexcept -> uint64_t
+{
+    return m_total_inflated;
+}
+
+auto inflater::get_compression_ratio(void) const noexcept -> double
+{
+    if (m_total_compressed == 0)
+        return 1.0;
+    return static_cast< double >(m_total_inflated) / static_cast< double >(m_total_compressed);
+}
+
+} // namespace qyzk::ohno
@@ -0,0 +1,48 @@
+#ifndef __QYZK_OHNO_INFLATER_H__
+#define __QYZK_OHNO_INFLATER_H__
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include <boost/beast/core/flat_buffer.hpp>
+#include <zlib.h>
+
+namespace qyzk::ohno
+{
+
+/*
+ * zlib-stream transport decompression, one per gateway connection
+ * the zlib context lives as long as the connection, output goes to a buffer of the caller's
+ */
+class inflater
+{
+public:
+    inflater(void);
+    ~inflater(void);
+
+    inflater(inflater const&) = delete;
+    auto operator=(inflater const&) -> inflater& = delete;
+
+    // appends the inflated message to output, returns true once the payload in it is complete
+    // a payload may come in any number of pieces, the suffix ending it is found even when split between them
+    auto feed(
+        std::string_view const compressed,
+        boost::beast::flat_buffer& output)
+        -> bool;
+
+    auto get_compressed_size(void) const noexcept -> uint64_t;
+    auto get_inflated_size(void) const noexcept -> uint64_t;
+    auto get_compression_ratio(void) const noexcept -> double;
+
+private:
+    z_stream m_stream;
+    uint64_t m_total_compressed;
+    uint64_t m_total_inflated;
+    std::array< char, 4 > m_tail; // the last bytes fed, as many as the suffix is long
+    std::size_t m_size_tail;
+}; // class qyzk::ohno::inflater
+
+} // namespace qyzk::ohno
+
+#endif
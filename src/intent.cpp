@@ -0,0 +1,87 @@
+#include "./intent.h"
+
+namespace
+{
+
+using qyzk::ohno::intent_type;
+
+constexpr auto operator|(intent_type const lhs, intent_type const rhs) noexcept -> uint32_t
+{
+    return static_cast< uint32_t >(lhs) | static_cast< uint32_t >(rhs);
+}
+
+constexpr auto bit(intent_type const intent) noexcept -> uint32_t
+{
+    return static_cast< uint32_t >(intent);
+}
+
+} // namespace
+
+namespace qyzk::ohno
+{
+
+auto get_intents(event_type const event) noexcept -> uint32_t
+{
+    switch (event)
+    {
+    case event_type::guild_create:
+    case event_type::guild_update:
+    case event_type::guild_delete:
+    case event_type::guild_role_create:
+    case event_type::guild_role_update:
+    case event_type::guild_role_delete:
+    case event_type::channel_create:
+    case event_type::channel_update:
+    case event_type::channel_delete:
+        return bit(intent_type::guilds);
+
+    case event_type::channel_pins_update:
+        return intent_type::guilds | intent_type::direct_messages;
+
+    case event_type::guild_member_add:
+    case event_type::guild_member_update:
+    case event_type::guild_member_remove:
+        return bit(intent_type::guild_members);
+
+    case event_type::guild_ban_add:
+    case event_type::guild_ban_remove:
+        return bit(intent_type::guild_bans);
+
+    case event_type::guild_emojis_update:
+        return bit(intent_type::guild_emojis);
+
+    case event_type::guild_integrations_update:
+        return bit(intent_type::guild_integrations);
+
+    case event_type::webhooks_update:
+        return bit(intent_type::guild_webhooks);
+
+    case event_type::voice_state_update:
+        return bit(intent_type::guild_voice_states);
+
+    case event_type::presence_update:
+        return bit(intent_type::guild_presences);
+
+    case event_type::message_create:
+    case event_type::message_update:
+    case event_type::message_delete:
+        return intent_type::guild_messages | intent_type::direct_messages;
+
+    case event_type::message_delete_bulk:
+        return bit(intent_type::guild_messages);
+
+    case event_type::message_reaction_add:
+    case event_type::message_reaction_remove:
+    case event_type::message_reaction_remove_all:
+        return intent_type::guild_message_reactions | intent_type::direct_message_reactions;
+
+    case event_type::typing_start:
+        return intent_type::guild_message_typing | intent_type::direct_message_typing;
+
+    default:
+        // hello, ready, resumed and the like are always sent
+        return 0;
+    }
+}
+
+} // namespace qyzk::ohno
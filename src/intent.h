@@ -0,0 +1,36 @@
+#ifndef __QYZK_OHNO_INTENT_H__
+#define __QYZK_OHNO_INTENT_H__
+
+#include <cstdint>
+
+#include "./event.h"
+
+namespace qyzk::ohno
+{
+
+enum class intent_type : uint32_t
+{
+    guilds = 1 << 0,
+    guild_members = 1 << 1,
+    guild_bans = 1 << 2,
+    guild_emojis = 1 << 3,
+    guild_integrations = 1 << 4,
+    guild_webhooks = 1 << 5,
+    guild_invites = 1 << 6,
+    guild_voice_states = 1 << 7,
+    guild_presences = 1 << 8,
+    guild_messages = 1 << 9,
+    guild_message_reactions = 1 << 10,
+    guild_message_typing = 1 << 11,
+    direct_messages = 1 << 12,
+    direct_message_reactions = 1 << 13,
+    direct_message_typing = 1 << 14,
+    message_content = 1 << 15,
+}; // enum class intent_type
+
+// gateway intents that have to be set for the event to be sent at all
+auto get_intents(event_type const event) noexcept -> uint32_t;
+
+} // namespace qyzk::ohno
+
+#endif
@@ -1,5 +1,8 @@
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
 
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
@@ -12,12 +15,17 @@
 #include "./cache.hpp"
 #include "./config.h"
 #include "./http_request.h"
+#include "./resolver_cache.h"
+#include "./tls_session_cache.h"
 
 using namespace boost::asio;
 
 namespace
 {
 
+// the gateway url rarely changes, but is asked for again now and then in case it does
+constexpr auto lifetime_gateway_url = std::chrono::hours(24);
+
 auto print_usage(std::string executable) -> void
 {
     std::cout << "usage:\n";
@@ -53,6 +61,68 @@ auto print_config(qyzk::ohno::config const& config)
     BOOST_LOG_TRIVIAL(debug) << "last event sequence: " << cache.get< key::last_event_sequence >();
 }
 
+// the gateway url of an earlier run while it's fresh and there's a session to resume, so a restart skips the rest call
+// starting a new session always asks, it counts against the session start limit
+auto discover_gateway(
+    std::filesystem::path const& path_config,
+    qyzk::ohno::config& config,
+    ssl::context& context_ssl,
+    qyzk::ohno::resolver_cache& resolver)
+    -> std::optional< std::string >
+{
+    using key = qyzk::ohno::config_cache_descriptor::key_type;
+
+    auto& cache = config.get_cache();
+    auto const now = std::chrono::duration_cast< std::chrono::seconds >(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    if (cache.has< key::session_id >() && cache.has< key::gateway_url >()
+        && cache.has< key::gateway_url_expiry >() && now < cache.get< key::gateway_url_expiry >())
+    {
+        BOOST_LOG_TRIVIAL(debug) << "resuming at cached gateway url, skipping gateway discovery";
+        return cache.get< key::gateway_url >();
+    }
+
+    // the io context doesn't run yet, so this is the one lookup that blocks
+    auto const hosts_http = resolver.resolve(config.get_discord_hostname(), "https");
+    auto const material_bot = qyzk::ohno::get_gateway_bot(config, context_ssl, hosts_http);
+    if (material_bot.session_start_limit.remaining == 0)
+    {
+        auto const reset_after = material_bot.session_start_limit.reset_after;
+        BOOST_LOG_TRIVIAL(error) << "no session is remaining try after " << (reset_after / 1000) << " seconds";
+        return std::nullopt;
+    }
+
+    auto const lifetime = std::chrono::duration_cast< std::chrono::seconds >(lifetime_gateway_url).count();
+    cache.set< key::gateway_url >(material_bot.url);
+    cache.set< key::gateway_url_expiry >(static_cast< int64_t >(now + lifetime));
+    qyzk::ohno::save_config(path_config, config);
+    return material_bot.url;
+}
+
+auto run(
+    io_context& context_io,
+    std::size_t const threads)
+    -> void
+{
+    // the calling thread is one of the io threads
+    std::vector< std::thread > threads_io;
+    threads_io.reserve(threads - 1);
+    for (std::size_t i = 1; i < threads; ++i)
+    {
+        threads_io.emplace_back(
+            [&context_io](void)
+            {
+                context_io.run();
+            });
+    }
+
+    context_io.run();
+    for (auto& thread : threads_io)
+    {
+        thread.join();
+    }
+}
+
 auto handle_signal(
     boost::system::error_code const& error,
     int const signal,
@@ -95,8 +165,19 @@ auto main(
     }
     BOOST_LOG_TRIVIAL(debug) << "initialized logger";
 
-    io_context context_io;
+    // every tls connection goes through the one context, so that any of them can resume a session another started
+    // declared first so the cache outlives the context pointing at it
+    qyzk::ohno::tls_session_cache sessions_tls;
     ssl::context context_ssl(ssl::context::tlsv12_client);
+    try
+    {
+        sessions_tls.attach(context_ssl);
+    }
+    catch (std::exception const& error)
+    {
+        BOOST_LOG_TRIVIAL(error) << error.what();
+        return EXIT_FAILURE;
+    }
 
     std::unique_ptr< qyzk::ohno::config > config_p;
     {
@@ -113,15 +194,21 @@ auto main(
     }
 
     auto& config = *config_p;
-    auto hosts_http = qyzk::ohno::resolve(config.get_discord_hostname(), "https");
-    auto const material_bot = qyzk::ohno::get_gateway_bot(config, hosts_http);
-    if (material_bot.session_start_limit.remaining == 0)
+    io_context context_io(static_cast< int >(config.get_io_threads()));
+    // addresses of the rest api and the gateway, shared by everything connecting to either
+    qyzk::ohno::resolver_cache resolver(context_io, std::chrono::seconds(config.get_dns_ttl()));
+    std::optional< std::string > url_gateway;
+    try
     {
-        auto const reset_after = material_bot.session_start_limit.reset_after;
-        BOOST_LOG_TRIVIAL(error) << "no session is remaining try after " << (reset_after / 1000) << " seconds";
-        config_p.reset();
+        url_gateway = discover_gateway(argv[1], config, context_ssl, resolver);
+    }
+    catch (std::exception const& error)
+    {
+        BOOST_LOG_TRIVIAL(error) << "failed to discover gateway: " << error.what();
         return EXIT_FAILURE;
     }
+    if (!url_gateway)
+        return EXIT_FAILURE;
 
     std::unique_ptr< qyzk::ohno::bot > bot_p;
 
@@ -136,27 +223,19 @@ auto main(
             std::ref(bot_p),
             std::ref(interrupted)));
 
-    while (!interrupted)
+    try
     {
-        if (context_io.stopped())
-        {
-            BOOST_LOG_TRIVIAL(warning) << "io context has stopped";
-            context_io.restart();
-        }
-
-        try
-        {
-            bot_p.reset(new qyzk::ohno::bot(argv[1], context_io, context_ssl, config, material_bot));
-        }
-        catch (std::exception const& error)
-        {
-            BOOST_LOG_TRIVIAL(error) << "failed to initialize bot: " << error.what();
-            return EXIT_FAILURE;
-        }
-
-        bot_p->async_listen_event();
-        context_io.run();
+        bot_p.reset(new qyzk::ohno::bot(argv[1], context_io, context_ssl, resolver, config, *url_gateway));
     }
+    catch (std::exception const& error)
+    {
+        BOOST_LOG_TRIVIAL(error) << "failed to initialize bot: " << error.what();
+        return EXIT_FAILURE;
+    }
+
+    // reconnects happen inside the bot, the io context only stops when the bot can't go on
+    bot_p->start();
+    run(context_io, config.get_io_threads());
 
-    return EXIT_SUCCESS;
+    return interrupted ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -2,8 +2,8 @@
 #define __QYZK_OHNO_OPCODE_H__
 
 #include <cstdint>
-#include <map>
-#include <string>
+
+#include "./perfect_hash.hpp"
 
 namespace qyzk::ohno
 {
@@ -15,17 +15,35 @@ enum class opcode_type : uint32_t
     identify = 2,
     status_update = 3,
     voice_state_update = 4,
-    unknown = 5,
+    voice_server_ping = 5,
     resume = 6,
     reconnect = 7,
     request_guild_members = 8,
     invalid_session = 9,
     hello = 10,
     heartbeat_ack = 11,
+    unknown = UINT32_MAX, // missing from the frame, kept past any opcode the gateway numbers
 }; // enum class opcode_type
 
-using opcode_names_type = std::map< opcode_type, std::string >;
-extern opcode_names_type opcode_names;
+using opcode_names_type = qyzk::perfect_hash_table< opcode_type, static_cast< std::size_t >(opcode_type::heartbeat_ack) + 1 >;
+
+inline constexpr opcode_names_type opcode_names {
+    {
+        "dispatch",
+        "heartbeat",
+        "identify",
+        "status_update",
+        "voice_state_update",
+        "voice_server_ping",
+        "resume",
+        "reconnect",
+        "request_guild_members",
+        "invalid_session",
+        "hello",
+        "heartbeat_ack",
+    },
+    opcode_type::unknown,
+};
 
 } // namespace qyzk::ohno
 
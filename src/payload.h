@@ -0,0 +1,39 @@
+#ifndef __QYZK_OHNO_PAYLOAD_H__
+#define __QYZK_OHNO_PAYLOAD_H__
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "./arena.h"
+
+namespace qyzk::ohno
+{
+
+/*
+ * parsed inbound gateway payload, every node and string lives in the frame's arena
+ * handlers copy out whatever they keep past the event, e.g. with std::string(get_string(...))
+ */
+using payload_string_type = std::basic_string< char, std::char_traits< char >, arena_allocator< char > >;
+using payload_type = nlohmann::basic_json<
+    std::map,
+    std::vector,
+    payload_string_type,
+    bool,
+    std::int64_t,
+    std::uint64_t,
+    double,
+    arena_allocator >;
+
+inline auto get_string(payload_type const& value) -> std::string_view
+{
+    return value.get_ref< payload_string_type const& >();
+}
+
+} // namespace qyzk::ohno
+
+#endif
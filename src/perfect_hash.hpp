@@ -0,0 +1,102 @@
+#ifndef __QYZK_PERFECT_HASH_H__
+#define __QYZK_PERFECT_HASH_H__
+
+/*
+ * compile time perfect hash between enum values and their names
+ * names are indexed by the enum's underlying value, the hash only serves name to value lookup
+ */
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace qyzk
+{
+
+template <
+    typename enum_type,
+    std::size_t size
+>
+class perfect_hash_table
+{
+public:
+    using names_type = std::array< std::string_view, size >;
+
+    constexpr perfect_hash_table(names_type const& names, enum_type const unknown)
+        : m_names(names)
+        , m_unknown(unknown)
+        , m_seed(0)
+        , m_slots()
+    {
+        // try seeds until every name lands in its own slot, fails compilation if none does
+        while (!try_seed())
+            ++m_seed;
+    }
+
+    constexpr auto name(enum_type const value) const noexcept -> std::string_view
+    {
+        auto const index = static_cast< std::size_t >(value);
+        if (index >= size)
+            return "unknown";
+        return m_names[index];
+    }
+
+    constexpr auto find(std::string_view const name) const noexcept -> enum_type
+    {
+        auto const slot = m_slots[hash(name, m_seed) & (slot_count - 1)];
+        if (slot == 0 || m_names[slot - 1] != name)
+            return m_unknown;
+        return static_cast< enum_type >(slot - 1);
+    }
+
+private:
+    static_assert(size < UINT8_MAX);
+
+    static constexpr auto get_slot_count(void) noexcept -> std::size_t
+    {
+        // a sparse table keeps the seed search short
+        std::size_t count = 1;
+        while (count < size * 4)
+            count <<= 1;
+        return count;
+    }
+
+    static constexpr std::size_t slot_count = get_slot_count();
+
+    // fnv-1a
+    static constexpr auto hash(std::string_view const name, uint32_t const seed) noexcept -> uint32_t
+    {
+        uint32_t value = 2166136261u ^ (seed * 16777619u);
+        for (auto const c : name)
+        {
+            value ^= static_cast< uint8_t >(c);
+            value *= 16777619u;
+        }
+        return value;
+    }
+
+    constexpr auto try_seed(void) noexcept -> bool
+    {
+        for (auto& slot : m_slots)
+            slot = 0;
+
+        for (std::size_t index = 0; index < size; ++index)
+        {
+            auto& slot = m_slots[hash(m_names[index], m_seed) & (slot_count - 1)];
+            if (slot != 0)
+                return false;
+            slot = static_cast< uint8_t >(index + 1);
+        }
+        return true;
+    }
+
+    names_type m_names;
+    enum_type m_unknown;
+    uint32_t m_seed;
+    std::array< uint8_t, slot_count > m_slots; // name index + 1, 0 for empty slots
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,209 @@
+#include <exception>
+#include <memory>
+#include <utility>
+
+#include <boost/log/trivial.hpp>
+
+#include "./resolver_cache.h"
+
+namespace
+{
+
+class hostname_resolve_error : public std::exception
+{
+public:
+    virtual auto what(void) const noexcept -> const char* override
+    {
+        return "failed to resolve hostname";
+    }
+};
+
+auto get_key(
+    std::string const& hostname,
+    std::string const& service)
+    -> std::string
+{
+    return hostname + ':' + service;
+}
+
+} // namespace
+
+namespace qyzk::ohno
+{
+
+resolver_cache::resolver_cache(
+    boost::asio::io_context& context_io,
+    clock_type::duration const ttl)
+    : m_context_io(context_io)
+    , m_ttl(ttl)
+    , m_mutex()
+    , m_entries()
+    , m_is_closed(false)
+{
+}
+
+auto resolver_cache::async_resolve(
+    std::string const& hostname,
+    std::string const& service,
+    handler_type handler)
+    -> void
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+
+    auto& entry = m_entries[get_key(hostname, service)];
+    entry.is_used = true;
+    if (entry.results.empty())
+    {
+        entry.handlers.push_back(std::move(handler));
+        refresh(entry, hostname, service);
+        return;
+    }
+
+    if (clock_type::now() >= entry.expiry)
+        refresh(entry, hostname, service);
+
+    boost::asio::post(
+        m_context_io,
+        [handler = std::move(handler), results = entry.results](void)
+        {
+            handler({}, results);
+        });
+}
+
+auto resolver_cache::resolve(
+    std::string const& hostname,
+    std::string const& service)
+    -> results_type
+{
+    auto const key = get_key(hostname, service);
+    {
+        std::lock_guard< std::mutex > lock(m_mutex);
+        auto& entry = m_entries[key];
+        entry.is_used = true;
+        if (!entry.results.empty())
+        {
+            if (clock_type::now() >= entry.expiry)
+                refresh(entry, hostname, service);
+            return entry.results;
+        }
+    }
+
+    // only ever on start up or off the io threads, nothing else to answer with yet
+    boost::asio::ip::tcp::resolver resolver(m_context_io);
+    boost::system::error_code error;
+    auto results = resolver.resolve(hostname, service, error);
+    if (error)
+    {
+        BOOST_LOG_TRIVIAL(error) << "failed to resolve " << key << ": " << error.message();
+        throw hostname_resolve_error();
+    }
+
+    std::lock_guard< std::mutex > lock(m_mutex);
+    auto& entry = m_entries[key];
+    entry.results = results;
+    entry.expiry = clock_type::now() + m_ttl;
+    schedule_refresh(entry, hostname, service);
+    return results;
+}
+
+auto resolver_cache::close(void) -> void
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    m_is_closed = true;
+    for (auto& [key, entry] : m_entries)
+    {
+        if (entry.timer_refresh)
+            entry.timer_refresh->cancel();
+    }
+}
+
+auto resolver_cache::refresh(
+    entry& entry,
+    std::string const& hostname,
+    std::string const& service)
+    -> void
+{
+    if (entry.is_refreshing)
+        return;
+
+    BOOST_LOG_TRIVIAL(debug) << "resolving " << hostname << ':' << service;
+    entry.is_refreshing = true;
+    auto const resolver = std::make_shared< boost::asio::ip::tcp::resolver >(m_context_io);
+    resolver->async_resolve(
+        hostname,
+        service,
+        [this, resolver, hostname, service](boost::system::error_code const& error, results_type const& results)
+        {
+            handle_resolve(hostname, service, error, results);
+        });
+}
+
+auto resolver_cache::schedule_refresh(
+    entry& entry,
+    std::string const& hostname,
+    std::string const& service)
+    -> void
+{
+    if (m_is_closed)
+        return;
+
+    if (!entry.timer_refresh)
+        entry.timer_refresh = std::make_unique< boost::asio::steady_timer >(m_context_io);
+    entry.timer_refresh->expires_at(entry.expiry);
+    entry.timer_refresh->async_wait(
+        [this, &entry, hostname, service](boost::system::error_code const& error)
+        {
+            if (error)
+                return;
+
+            std::lock_guard< std::mutex > lock(m_mutex);
+            // a host nobody asked for in a whole ttl isn't kept warm, its next use refreshes it
+            if (m_is_closed || !entry.is_used)
+                return;
+
+            entry.is_used = false;
+            refresh(entry, hostname, service);
+        });
+}
+
+auto resolver_cache::handle_resolve(
+    std::string const& hostname,
+    std::string const& service,
+    boost::system::error_code const& error,
+    results_type const& results)
+    -> void
+{
+    auto const key = get_key(hostname, service);
+    std::vector< handler_type > handlers;
+    auto answer = results;
+    auto answer_error = error;
+    {
+        std::lock_guard< std::mutex > lock(m_mutex);
+        auto& entry = m_entries[key];
+        entry.is_refreshing = false;
+        handlers = std::exchange(entry.handlers, {});
+
+        if (!error)
+        {
+            entry.results = results;
+            entry.expiry = clock_type::now() + m_ttl;
+            schedule_refresh(entry, hostname, service);
+        }
+        else if (!entry.results.empty())
+        {
+            // the next use tries again
+            BOOST_LOG_TRIVIAL(warning) << "failed to refresh " << key << ", keeping stale addresses: " << error.message();
+            answer = entry.results;
+            answer_error = {};
+        }
+        else
+        {
+            BOOST_LOG_TRIVIAL(error) << "failed to resolve " << key << ": " << error.message();
+        }
+    }
+
+    for (auto const& handler : handlers)
+        handler(answer_error, answer);
+}
+
+} // namespace qyzk::ohno
@@ -0,0 +1,95 @@
+#ifndef __QYZK_OHNO_RESOLVER_CACHE_H__
+#define __QYZK_OHNO_RESOLVER_CACHE_H__
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+namespace qyzk::ohno
+{
+
+/*
+ * resolved addresses shared by the gateway and rest clients, looked up again once their ttl is over
+ * a host asked for since its last lookup is refreshed in the background as it expires, any other is refreshed
+ * on its next use, answered with the expired addresses meanwhile
+ * addresses are kept when a refresh fails, only a host never resolved has to wait for the lookup
+ * the system resolver doesn't tell record ttls, every entry lives for the same configured ttl
+ * safe to call from any thread
+ */
+class resolver_cache
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+    using results_type = boost::asio::ip::tcp::resolver::results_type;
+    using handler_type = std::function< void(
+        boost::system::error_code const& error,
+        results_type const& results) >;
+
+    resolver_cache(
+        boost::asio::io_context& context_io,
+        clock_type::duration const ttl);
+
+    resolver_cache(resolver_cache const&) = delete;
+    auto operator=(resolver_cache const&) -> resolver_cache& = delete;
+
+    // the handler runs on the io context, never from inside this call
+    auto async_resolve(
+        std::string const& hostname,
+        std::string const& service,
+        handler_type handler)
+        -> void;
+    // blocks only for a host never resolved, throws if that lookup fails
+    // for start up before the io context runs, i.e. gateway discovery in main, everything else goes through async_resolve
+    auto resolve(
+        std::string const& hostname,
+        std::string const& service)
+        -> results_type;
+    // stops the background refreshes, so that the io context can run out of work
+    auto close(void) -> void;
+
+private:
+    struct entry
+    {
+        results_type results;
+        clock_type::time_point expiry;
+        bool is_used; // asked for since the last lookup
+        bool is_refreshing;
+        std::vector< handler_type > handlers; // waiting for the first lookup
+        std::unique_ptr< boost::asio::steady_timer > timer_refresh;
+    };
+
+    // with the lock held, starts a lookup unless one is already on its way
+    auto refresh(
+        entry& entry,
+        std::string const& hostname,
+        std::string const& service)
+        -> void;
+    // with the lock held, refreshes the entry when it expires if it's still in use by then
+    auto schedule_refresh(
+        entry& entry,
+        std::string const& hostname,
+        std::string const& service)
+        -> void;
+    auto handle_resolve(
+        std::string const& hostname,
+        std::string const& service,
+        boost::system::error_code const& error,
+        results_type const& results)
+        -> void;
+
+    boost::asio::io_context& m_context_io;
+    clock_type::duration const m_ttl;
+    std::mutex m_mutex;
+    std::map< std::string, entry > m_entries; // by hostname and service, never erased so timers can hold on to them
+    bool m_is_closed;
+}; // class qyzk::ohno::resolver_cache
+
+} // namespace qyzk::ohno
+
+#endif
@@ -0,0 +1,547 @@
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#include <boost/log/trivial.hpp>
+
+#include "./rest_client.h"
+#include "./tls_session_cache.h"
+
+using namespace boost::asio;
+using namespace boost::beast;
+using json = nlohmann::json;
+
+namespace
+{
+
+// kept connections at most, requests in flight beyond that close theirs once done
+constexpr std::size_t count_connection_idle_max = 4;
+
+// a connection idle for longer is likely closed by the server, and not worth checking
+constexpr auto timeout_idle = std::chrono::seconds(30);
+
+// idle connections outlive timeout_idle by this much at most
+constexpr auto interval_sweep = std::chrono::seconds(10);
+
+// for the endpoints with a function of their own, from resolving to the last byte of the response
+constexpr auto timeout_request = std::chrono::seconds(10);
+
+// sending these again has the same effect as sending them once
+auto is_idempotent(http::verb const method) -> bool
+{
+    switch (method)
+    {
+    case http::verb::get:
+    case http::verb::head:
+    case http::verb::put:
+    case http::verb::delete_:
+    case http::verb::options:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// the server closed the connection rather than answering, as it does with connections it has given up on
+auto is_closed_unanswered(error_code const& error) -> bool
+{
+    return error == http::error::end_of_stream
+        || error == boost::asio::error::eof
+        || error == boost::asio::error::connection_reset
+        || error == boost::asio::ssl::error::stream_truncated;
+}
+
+// an idle connection has nothing to read, anything there is a close notify, an eof or an error
+auto is_alive(qyzk::ohno::stream_type& stream) -> bool
+{
+    auto& socket = get_lowest_layer(stream).socket();
+    error_code error;
+    socket.non_blocking(true, error);
+    if (error)
+        return false;
+
+    char letter;
+    socket.receive(boost::asio::buffer(&letter, 1), socket_base::message_peek, error);
+
+    error_code error_blocking;
+    socket.non_blocking(false, error_blocking);
+    return error == boost::asio::error::would_block && !error_blocking;
+}
+
+} // namespace
+
+namespace qyzk::ohno
+{
+
+/*
+ * one request from a kept or a new connection to the handler, keeps itself alive through the handlers it passes on
+ * runs on a strand of its own, which a new connection takes over, or on the strand of the kept connection it got
+ */
+class rest_operation : public std::enable_shared_from_this< rest_operation >
+{
+public:
+    using request_type = http::request< http::string_body >;
+
+    rest_operation(
+        rest_client& client,
+        request_type request,
+        rest_client::clock_type::duration const timeout,
+        rest_client::handler_type handler)
+        : m_client(client)
+        , m_request(std::move(request))
+        , m_response()
+        , m_deadline(rest_client::clock_type::now() + timeout)
+        , m_handler(std::move(handler))
+        , m_strand(make_strand(client.m_context_io))
+        , m_timer_resolve(m_strand)
+        , m_connection()
+        , m_is_resolving(false)
+        , m_is_reused(false)
+        , m_is_retried(false)
+        , m_is_written(false)
+        , m_is_answered(false)
+    {
+    }
+
+    auto start(void) -> void
+    {
+        m_connection = m_client.acquire();
+        if (!m_connection)
+        {
+            connect();
+            return;
+        }
+
+        m_is_reused = true;
+        boost::asio::dispatch(
+            m_connection->stream->get_executor(),
+            [self = shared_from_this()](void)
+            {
+                self->write();
+            });
+    }
+
+private:
+    auto connect(void) -> void
+    {
+        // a lookup can't be cancelled, past the deadline its answer is just left unused
+        m_is_resolving = true;
+        m_timer_resolve.expires_at(m_deadline);
+        m_timer_resolve.async_wait(
+            [self = shared_from_this()](error_code const& error)
+            {
+                self->handle_resolve_timeout(error);
+            });
+
+        m_client.m_resolver.async_resolve(
+            m_client.m_config.get_discord_hostname(),
+            "https",
+            [self = shared_from_this()](error_code const& error, resolver_cache::results_type const& hosts)
+            {
+                boost::asio::dispatch(
+                    self->m_strand,
+                    [self, error, hosts](void)
+                    {
+                        self->handle_resolve(error, hosts);
+                    });
+            });
+    }
+
+    auto handle_resolve_timeout(error_code const& error) -> void
+    {
+        if (error || !m_is_resolving)
+            return;
+
+        m_is_resolving = false;
+        complete(boost::beast::error::timeout);
+    }
+
+    auto handle_resolve(
+        error_code const& error,
+        resolver_cache::results_type const& hosts)
+        -> void
+    {
+        if (!m_is_resolving)
+            return;
+
+        m_is_resolving = false;
+        m_timer_resolve.cancel();
+        if (error)
+        {
+            complete(error);
+            return;
+        }
+
+        auto connection = std::make_unique< rest_client::connection >();
+        connection->stream = std::make_unique< stream_type >(m_strand, m_client.m_context_ssl);
+        auto* const ssl = connection->stream->native_handle();
+        if (SSL_set_tlsext_host_name(ssl, m_client.m_config.get_discord_hostname().c_str()) != 1)
+        {
+            complete(boost::asio::error::invalid_argument);
+            return;
+        }
+        tls_session_cache::resume(ssl);
+        m_connection = std::move(connection);
+
+        // the deadline is the request's, a slow connect leaves that much less for the exchange
+        get_lowest_layer(*m_connection->stream).expires_at(m_deadline);
+        get_lowest_layer(*m_connection->stream).async_connect(
+            hosts,
+            [self = shared_from_this()](error_code const& error, ip::tcp::endpoint const&)
+            {
+                self->handle_connect(error);
+            });
+    }
+
+    auto handle_connect(error_code const& error) -> void
+    {
+        if (error)
+        {
+            complete(error);
+            return;
+        }
+
+        m_connection->stream->async_handshake(
+            ssl::stream_base::client,
+            [self = shared_from_this()](error_code const& error)
+            {
+                self->handle_handshake(error);
+            });
+    }
+
+    auto handle_handshake(error_code const& error) -> void
+    {
+        if (error)
+        {
+            complete(error);
+            return;
+        }
+
+        tls_session_cache::record(m_connection->stream->native_handle());
+        ++m_client.m_count_connected;
+        BOOST_LOG_TRIVIAL(debug) << "opened rest connection, " << m_client.m_count_connected.load() << " so far";
+        write();
+    }
+
+    auto write(void) -> void
+    {
+        get_lowest_layer(*m_connection->stream).expires_at(m_deadline);
+        http::async_write(
+            *m_connection->stream,
+            m_request,
+            [self = shared_from_this()](error_code const& error, std::size_t const)
+            {
+                self->handle_write(error);
+            });
+    }
+
+    auto handle_write(error_code const& error) -> void
+    {
+        if (error)
+        {
+            retry_or_complete(error);
+            return;
+        }
+
+        m_is_written = true;
+        http::async_read(
+            *m_connection->stream,
+            m_connection->buffer,
+            m_response,
+            [self = shared_from_this()](error_code const& error, std::size_t const size)
+            {
+                self->handle_read(error, size);
+            });
+    }
+
+    auto handle_read(
+        error_code const& error,
+        std::size_t const size)
+        -> void
+    {
+        if (error)
+        {
+            // bytes short of a whole header may be left in the buffer rather than counted
+            m_is_answered = size != 0 || m_connection->buffer.size() != 0;
+            retry_or_complete(error);
+            return;
+        }
+        complete(error);
+    }
+
+    auto retry_or_complete(error_code const& error) -> void
+    {
+        // the server may have closed a kept connection between the check and the write
+        if (!m_is_reused || m_is_retried || error == boost::beast::error::timeout)
+        {
+            complete(error);
+            return;
+        }
+
+        // once the whole request is out the server may have acted on it, only an idempotent one
+        // the server dropped before answering anything is safe to send again
+        if (m_is_written && (!is_idempotent(m_request.method()) || m_is_answered || !is_closed_unanswered(error)))
+        {
+            complete(error);
+            return;
+        }
+
+        BOOST_LOG_TRIVIAL(debug) << "kept rest connection failed, retrying on a new one: " << error.message();
+        ++m_client.m_count_retried;
+        m_is_retried = true;
+        m_is_written = false;
+        m_is_answered = false;
+        m_response = {};
+        get_lowest_layer(*m_connection->stream).close();
+        m_connection.reset();
+        connect();
+    }
+
+    auto complete(error_code error) -> void
+    {
+        json body;
+        if (error == boost::beast::error::timeout)
+        {
+            ++m_client.m_count_timed_out;
+            BOOST_LOG_TRIVIAL(error) << "rest request " << m_request.target() << " has timed out";
+        }
+        else if (error)
+        {
+            BOOST_LOG_TRIVIAL(error) << "failed to send rest request " << m_request.target() << ": " << error.message();
+        }
+        else
+        {
+            BOOST_LOG_TRIVIAL(debug) << "result: " << m_response.result_int() << " " << m_response.result();
+            body = parse_body(error);
+        }
+
+        if (m_connection)
+        {
+            if (!error && m_response.keep_alive())
+            {
+                get_lowest_layer(*m_connection->stream).expires_never();
+                m_client.release(std::move(m_connection));
+            }
+            else
+            {
+                // no tls shutdown, nothing is waiting for it
+                get_lowest_layer(*m_connection->stream).close();
+                m_connection.reset();
+            }
+        }
+
+        if (m_handler)
+            m_handler(error, body);
+    }
+
+    auto parse_body(error_code& error) -> json
+    {
+        if (m_response.result_int() == 204 || m_response.body().empty())
+            return json();
+
+        try
+        {
+            return json::parse(m_response.body());
+        }
+        catch (std::exception const& exception)
+        {
+            BOOST_LOG_TRIVIAL(warning) << "failed to parse response body: " << exception.what();
+            BOOST_LOG_TRIVIAL(warning) << m_response.body();
+            error = make_error_code(boost::system::errc::bad_message);
+            return json();
+        }
+    }
+
+    rest_client& m_client;
+    request_type const m_request;
+    http::response< http::string_body > m_response;
+    rest_client::clock_type::time_point const m_deadline;
+    rest_client::handler_type const m_handler;
+    rest_client::strand_type m_strand;
+    steady_timer m_timer_resolve; // the resolver cache has no deadline of its own
+    std::unique_ptr< rest_client::connection > m_connection;
+    bool m_is_resolving;
+    bool m_is_reused;
+    bool m_is_retried;
+    bool m_is_written; // all of the request went out, the server may have handled it
+    bool m_is_answered; // some of a response came back before the read failed
+}; // class qyzk::ohno::rest_operation
+
+rest_client::rest_client(
+    io_context& context_io,
+    ohno::config const& config,
+    ssl::context& context_ssl,
+    ohno::resolver_cache& resolver)
+    : m_context_io(context_io)
+    , m_config(config)
+    , m_context_ssl(context_ssl)
+    , m_resolver(resolver)
+    , m_mutex()
+    , m_connections_idle()
+    , m_timer_sweep(context_io)
+    , m_is_sweeping(false)
+    , m_is_closed(false)
+    , m_count_connected(0)
+    , m_count_reused(0)
+    , m_count_retried(0)
+    , m_count_timed_out(0)
+{
+}
+
+auto rest_client::send_message(
+    std::string const& channel,
+    std::string const& message,
+    handler_type handler)
+    -> void
+{
+    json body;
+    body["content"] = message;
+    async_request(http::verb::post, "/channels/" + channel + "/messages", body, timeout_request, std::move(handler));
+}
+
+auto rest_client::kick(
+    std::string const& guild,
+    std::string const& id,
+    handler_type handler)
+    -> void
+{
+    async_request(http::verb::delete_, "/guilds/" + guild + "/members/" + id, std::nullopt, timeout_request, std::move(handler));
+}
+
+auto rest_client::delete_message(
+    std::string const& channel,
+    std::string const& id,
+    handler_type handler)
+    -> void
+{
+    async_request(http::verb::delete_, "/channels/" + channel + "/messages/" + id, std::nullopt, timeout_request, std::move(handler));
+}
+
+auto rest_client::async_request(
+    http::verb const method,
+    std::string const& target,
+    std::optional< json > const& body,
+    clock_type::duration const timeout,
+    handler_type handler)
+    -> void
+{
+    http::request< http::string_body > request { method, m_config.get_http_api_location() + target, 11 };
+    request.set(http::field::host, m_config.get_discord_hostname());
+    request.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+    request.set(http::field::authorization, "Bot " + m_config.get_token());
+    request.keep_alive(true);
+    if (body)
+    {
+        request.set(http::field::content_type, "application/json");
+        request.body() = body->dump();
+    }
+    request.prepare_payload();
+
+    std::make_shared< rest_operation >(*this, std::move(request), timeout, std::move(handler))->start();
+}
+
+auto rest_client::get_statistics(void) const noexcept -> rest_client_statistics
+{
+    return {
+        m_count_connected.load(),
+        m_count_reused.load(),
+        m_count_retried.load(),
+        m_count_timed_out.load(),
+    };
+}
+
+auto rest_client::acquire(void) -> std::unique_ptr< connection >
+{
+    auto const now = clock_type::now();
+
+    std::lock_guard< std::mutex > lock(m_mutex);
+    while (!m_connections_idle.empty())
+    {
+        auto connection = std::move(m_connections_idle.back());
+        m_connections_idle.pop_back();
+        if (now - connection->time_used < timeout_idle && is_alive(*connection->stream))
+        {
+            ++m_count_reused;
+            return connection;
+        }
+
+        // no tls shutdown, the server is gone already or about to be
+        BOOST_LOG_TRIVIAL(debug) << "dropping closed or stale rest connection";
+        get_lowest_layer(*connection->stream).close();
+    }
+    return nullptr;
+}
+
+auto rest_client::release(std::unique_ptr< connection > connection) -> void
+{
+    connection->time_used = clock_type::now();
+
+    std::lock_guard< std::mutex > lock(m_mutex);
+    if (m_is_closed)
+    {
+        get_lowest_layer(*connection->stream).close();
+        return;
+    }
+
+    if (m_connections_idle.size() >= count_connection_idle_max)
+    {
+        // the oldest goes, it's the likeliest to have been closed by the server anyway
+        get_lowest_layer(*m_connections_idle.front()->stream).close();
+        m_connections_idle.erase(m_connections_idle.begin());
+    }
+    m_connections_idle.push_back(std::move(connection));
+    async_sweep();
+}
+
+auto rest_client::close(void) -> void
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    m_is_closed = true;
+    m_timer_sweep.cancel();
+    for (auto& connection : m_connections_idle)
+        get_lowest_layer(*connection->stream).close();
+    m_connections_idle.clear();
+}
+
+auto rest_client::async_sweep(void) -> void
+{
+    if (m_is_sweeping)
+        return;
+
+    m_is_sweeping = true;
+    m_timer_sweep.expires_after(interval_sweep);
+    m_timer_sweep.async_wait(
+        [this](error_code const& error)
+        {
+            sweep(error);
+        });
+}
+
+auto rest_client::sweep(error_code const& error) -> void
+{
+    auto const now = clock_type::now();
+
+    std::lock_guard< std::mutex > lock(m_mutex);
+    m_is_sweeping = false;
+    if (error || m_is_closed)
+        return;
+
+    // the server's close notify would otherwise sit unread on a socket nobody reuses
+    auto const is_stale = [now](std::unique_ptr< connection > const& connection)
+    {
+        if (now - connection->time_used < timeout_idle && is_alive(*connection->stream))
+            return false;
+
+        get_lowest_layer(*connection->stream).close();
+        return true;
+    };
+    auto const end = std::remove_if(m_connections_idle.begin(), m_connections_idle.end(), is_stale);
+    if (end != m_connections_idle.end())
+        BOOST_LOG_TRIVIAL(debug) << "swept " << (m_connections_idle.end() - end) << " idle rest connections";
+    m_connections_idle.erase(end, m_connections_idle.end());
+
+    if (!m_connections_idle.empty())
+        async_sweep();
+}
+
+} // namespace qyzk::ohno
@@ -0,0 +1,122 @@
+#ifndef __QYZK_OHNO_REST_CLIENT_H__
+#define __QYZK_OHNO_REST_CLIENT_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+#include <nlohmann/json.hpp>
+
+#include "./config.h"
+#include "./http_request.h"
+#include "./resolver_cache.h"
+
+namespace qyzk::ohno
+{
+
+struct rest_client_statistics
+{
+    uint64_t count_connected;
+    uint64_t count_reused;
+    uint64_t count_retried; // requests sent again after a kept connection turned out to be closed
+    uint64_t count_timed_out;
+};
+
+/*
+ * client for discord's rest api keeping http/1.1 connections alive between requests
+ * requests run on the io context without blocking and each has a deadline of its own,
+ * covering the lookup, the connect, the handshake and the exchange alike
+ * idle connections are checked before being reused, one the server has closed in the meantime is replaced,
+ * and swept in the background once they've been idle for too long
+ * safe to call from any thread, handlers run on an io thread
+ */
+class rest_client
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+    using handler_type = std::function< void(
+        boost::beast::error_code const& error,
+        nlohmann::json const& response) >;
+
+    rest_client(
+        boost::asio::io_context& context_io,
+        ohno::config const& config,
+        boost::asio::ssl::context& context_ssl,
+        ohno::resolver_cache& resolver);
+
+    rest_client(rest_client const&) = delete;
+    auto operator=(rest_client const&) -> rest_client& = delete;
+
+    auto send_message(
+        std::string const& channel,
+        std::string const& message,
+        handler_type handler = nullptr)
+        -> void;
+    auto kick(
+        std::string const& guild,
+        std::string const& id,
+        handler_type handler = nullptr)
+        -> void;
+    auto delete_message(
+        std::string const& channel,
+        std::string const& id,
+        handler_type handler = nullptr)
+        -> void;
+    // for endpoints without a function of their own, target is relative to the api location
+    auto async_request(
+        boost::beast::http::verb const method,
+        std::string const& target,
+        std::optional< nlohmann::json > const& body,
+        clock_type::duration const timeout,
+        handler_type handler)
+        -> void;
+    auto get_statistics(void) const noexcept -> rest_client_statistics;
+    // closes the idle connections and stops sweeping, requests in flight still finish but keep nothing
+    auto close(void) -> void;
+
+private:
+    friend class rest_operation;
+
+    using strand_type = boost::asio::strand< boost::asio::io_context::executor_type >;
+
+    struct connection
+    {
+        std::unique_ptr< stream_type > stream; // its handlers run on a strand of its own
+        boost::beast::flat_buffer buffer;
+        clock_type::time_point time_used;
+    };
+
+    // an idle connection still good to use, or nullptr
+    auto acquire(void) -> std::unique_ptr< connection >;
+    auto release(std::unique_ptr< connection > connection) -> void;
+    // with the lock held, starts the sweep unless it's already waiting
+    auto async_sweep(void) -> void;
+    auto sweep(boost::beast::error_code const& error) -> void;
+
+    boost::asio::io_context& m_context_io;
+    ohno::config const& m_config;
+    boost::asio::ssl::context& m_context_ssl;
+    ohno::resolver_cache& m_resolver;
+    std::mutex m_mutex;
+    std::vector< std::unique_ptr< connection > > m_connections_idle; // most recently used last
+    boost::asio::steady_timer m_timer_sweep; // only touched with the lock held
+    bool m_is_sweeping;
+    bool m_is_closed;
+    std::atomic< uint64_t > m_count_connected;
+    std::atomic< uint64_t > m_count_reused;
+    std::atomic< uint64_t > m_count_retried;
+    std::atomic< uint64_t > m_count_timed_out;
+}; // class qyzk::ohno::rest_client
+
+} // namespace qyzk::ohno
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef __QYZK_RING_H__
+#define __QYZK_RING_H__
+
+/*
+ * bounded lock free queue for any number of producers and consumers
+ * every cell carries a sequence number telling whose turn it is (dmitry vyukov's design)
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace qyzk
+{
+
+template <typename value_type>
+class ring
+{
+public:
+    // capacity is rounded up to a power of two
+    explicit ring(std::size_t const capacity)
+        : m_capacity(round_up(capacity))
+        , m_cells(new cell[m_capacity])
+        , m_head(0)
+        , m_tail(0)
+    {
+        for (std::size_t index = 0; index < m_capacity; ++index)
+            m_cells[index].sequence.store(index, std::memory_order_relaxed);
+    }
+
+    ring(ring const&) = delete;
+    auto operator=(ring const&) -> ring& = delete;
+
+    // moves from value only when there was room for it
+    auto try_push(value_type& value) -> bool
+    {
+        auto position = m_tail.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto& cell = m_cells[position & (m_capacity - 1)];
+            auto const sequence = cell.sequence.load(std::memory_order_acquire);
+            auto const difference = static_cast< std::ptrdiff_t >(sequence) - static_cast< std::ptrdiff_t >(position);
+            if (difference == 0)
+            {
+                if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.value = std::move(value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+                return false;
+            else
+                position = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    auto try_pop(value_type& value) -> bool
+    {
+        auto position = m_head.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto& cell = m_cells[position & (m_capacity - 1)];
+            auto const sequence = cell.sequence.load(std::memory_order_acquire);
+            auto const difference = static_cast< std::ptrdiff_t >(sequence) - static_cast< std::ptrdiff_t >(position + 1);
+            if (difference == 0)
+            {
+                if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    value = std::move(cell.value);
+                    cell.sequence.store(position + m_capacity, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+                return false;
+            else
+                position = m_head.load(std::memory_order_relaxed);
+        }
+    }
+
+    // only a snapshot while other threads are pushing or popping
+    auto size(void) const noexcept -> std::size_t
+    {
+        auto const tail = m_tail.load();
+        auto const head = m_head.load();
+        return tail > head ? tail - head : 0;
+    }
+
+    auto capacity(void) const noexcept -> std::size_t
+    {
+        return m_capacity;
+    }
+
+private:
+    struct cell
+    {
+        std::atomic< std::size_t > sequence;
+        value_type value;
+    };
+
+    static constexpr auto round_up(std::size_t const capacity) noexcept -> std::size_t
+    {
+        std::size_t result = 2;
+        while (result < capacity)
+            result <<= 1;
+        return result;
+    }
+
+    std::size_t const m_capacity;
+    std::unique_ptr< cell[] > const m_cells;
+    alignas(64) std::atomic< std::size_t > m_head;
+    alignas(64) std::atomic< std::size_t > m_tail;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,401 @@
+#include <exception>
+
+#include "./stream_parser.h"
+
+namespace
+{
+
+class stream_parse_error : public std::exception
+{
+public:
+    virtual auto what(void) const noexcept -> const char* override
+    {
+        return "failed to parse streamed json text";
+    }
+};
+
+auto is_whitespace(char const letter) noexcept -> bool
+{
+    return letter == ' ' || letter == '\t' || letter == '\n' || letter == '\r';
+}
+
+auto is_number_letter(char const letter) noexcept -> bool
+{
+    return (letter >= '0' && letter <= '9') || letter == '-' || letter == '+' || letter == '.' || letter == 'e' || letter == 'E';
+}
+
+auto is_digit(char const letter) noexcept -> bool
+{
+    return letter >= '0' && letter <= '9';
+}
+
+// -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?, the way the dom decoders take it
+auto is_number(std::string_view const text) noexcept -> bool
+{
+    auto it = text.begin();
+    auto const end = text.end();
+    auto const skip_digits = [&it, end](void) -> bool
+    {
+        auto const begin = it;
+        while (it != end && is_digit(*it))
+            ++it;
+        return it != begin;
+    };
+
+    if (it != end && *it == '-')
+        ++it;
+    if (it != end && *it == '0')
+        ++it;
+    else if (!skip_digits())
+        return false;
+
+    if (it != end && *it == '.')
+    {
+        ++it;
+        if (!skip_digits())
+            return false;
+    }
+
+    if (it != end && (*it == 'e' || *it == 'E'))
+    {
+        ++it;
+        if (it != end && (*it == '+' || *it == '-'))
+            ++it;
+        if (!skip_digits())
+            return false;
+    }
+
+    return it == end;
+}
+
+auto get_hex_value(char const letter) -> uint32_t
+{
+    if (letter >= '0' && letter <= '9')
+        return static_cast< uint32_t >(letter - '0');
+    if (letter >= 'a' && letter <= 'f')
+        return static_cast< uint32_t >(letter - 'a' + 10);
+    if (letter >= 'A' && letter <= 'F')
+        return static_cast< uint32_t >(letter - 'A' + 10);
+    throw stream_parse_error();
+}
+
+auto append_utf8(std::string& text, uint32_t const code_point) -> void
+{
+    if (code_point < 0x80)
+    {
+        text.push_back(static_cast< char >(code_point));
+    }
+    else if (code_point < 0x800)
+    {
+        text.push_back(static_cast< char >(0xc0 | (code_point >> 6)));
+        text.push_back(static_cast< char >(0x80 | (code_point & 0x3f)));
+    }
+    else if (code_point < 0x10000)
+    {
+        text.push_back(static_cast< char >(0xe0 | (code_point >> 12)));
+        text.push_back(static_cast< char >(0x80 | ((code_point >> 6) & 0x3f)));
+        text.push_back(static_cast< char >(0x80 | (code_point & 0x3f)));
+    }
+    else
+    {
+        text.push_back(static_cast< char >(0xf0 | (code_point >> 18)));
+        text.push_back(static_cast< char >(0x80 | ((code_point >> 12) & 0x3f)));
+        text.push_back(static_cast< char >(0x80 | ((code_point >> 6) & 0x3f)));
+        text.push_back(static_cast< char >(0x80 | (code_point & 0x3f)));
+    }
+}
+
+} // namespace
+
+namespace qyzk::ohno
+{
+
+stream_parser::stream_parser(ohno::stream_handler& handler)
+    : m_handler(handler)
+    , m_state(state_type::value)
+    , m_containers()
+    , m_is_container_empty(false)
+    , m_is_key(false)
+    , m_token()
+    , m_code_unit(0)
+    , m_count_hex(0)
+    , m_surrogate_high(0)
+{
+}
+
+auto stream_parser::feed(std::string_view const text) -> void
+{
+    for (auto const letter : text)
+        feed(letter);
+}
+
+auto stream_parser::finish(void) -> void
+{
+    // a number at the very end has nothing after it to tell that it's over
+    if (m_state == state_type::number && m_containers.empty())
+        end_number();
+    if (m_state != state_type::done)
+        throw stream_parse_error();
+}
+
+auto stream_parser::is_done(void) const noexcept -> bool
+{
+    return m_state == state_type::done;
+}
+
+auto stream_parser::feed(char const letter) -> void
+{
+    switch (m_state)
+    {
+    case state_type::value:
+        feed_value(letter);
+        break;
+
+    case state_type::key:
+        if (is_whitespace(letter))
+            break;
+        if (letter == '}' && m_is_container_empty)
+        {
+            end_container(letter);
+            break;
+        }
+        if (letter != '"')
+            throw stream_parse_error();
+        m_is_key = true;
+        m_state = state_type::string;
+        break;
+
+    case state_type::colon:
+        if (is_whitespace(letter))
+            break;
+        if (letter != ':')
+            throw stream_parse_error();
+        m_state = state_type::value;
+        break;
+
+    case state_type::comma:
+        feed_comma(letter);
+        break;
+
+    case state_type::string:
+        // a high surrogate has to be followed right away by the escape of its low half
+        if (m_surrogate_high != 0 && letter != '\\')
+            throw stream_parse_error();
+        if (letter == '"')
+            end_string();
+        else if (letter == '\\')
+            m_state = state_type::string_escape;
+        else
+            m_token.push_back(letter);
+        break;
+
+    case state_type::string_escape:
+        feed_escape(letter);
+        break;
+
+    case state_type::string_unicode:
+        feed_unicode(letter);
+        break;
+
+    case state_type::number:
+        if (is_number_letter(letter))
+        {
+            m_token.push_back(letter);
+            break;
+        }
+        end_number();
+        feed(letter);
+        break;
+
+    case state_type::literal:
+        if (letter >= 'a' && letter <= 'z')
+        {
+            m_token.push_back(letter);
+            break;
+        }
+        end_literal();
+        feed(letter);
+        break;
+
+    case state_type::done:
+        if (!is_whitespace(letter))
+            throw stream_parse_error();
+        break;
+    }
+}
+
+auto stream_parser::feed_value(char const letter) -> void
+{
+    if (is_whitespace(letter))
+        return;
+
+    switch (letter)
+    {
+    case '{':
+        m_handler.start_object();
+        m_containers.push_back('{');
+        m_is_container_empty = true;
+        m_state = state_type::key;
+        break;
+
+    case '[':
+        m_handler.start_array();
+        m_containers.push_back('[');
+        m_is_container_empty = true;
+        m_state = state_type::value;
+        break;
+
+    case ']':
+        if (!m_is_container_empty)
+            throw stream_parse_error();
+        end_container(letter);
+        break;
+
+    case '"':
+        m_is_key = false;
+        m_state = state_type::string;
+        break;
+
+    default:
+        if (letter >= 'a' && letter <= 'z')
+            m_state = state_type::literal;
+        else if (is_number_letter(letter))
+            m_state = state_type::number;
+        else
+            throw stream_parse_error();
+        m_token.push_back(letter);
+    }
+}
+
+auto stream_parser::feed_comma(char const letter) -> void
+{
+    if (is_whitespace(letter))
+        return;
+
+    if (letter == '}' || letter == ']')
+    {
+        end_container(letter);
+        return;
+    }
+    if (letter != ',')
+        throw stream_parse_error();
+
+    m_is_container_empty = false;
+    m_state = m_containers.back() == '{' ? state_type::key : state_type::value;
+}
+
+auto stream_parser::feed_escape(char const letter) -> void
+{
+    if (m_surrogate_high != 0 && letter != 'u')
+        throw stream_parse_error();
+
+    m_state = state_type::string;
+    switch (letter)
+    {
+    case '"': m_token.push_back('"'); break;
+    case '\\': m_token.push_back('\\'); break;
+    case '/': m_token.push_back('/'); break;
+    case 'b': m_token.push_back('\b'); break;
+    case 'f': m_token.push_back('\f'); break;
+    case 'n': m_token.push_back('\n'); break;
+    case 'r': m_token.push_back('\r'); break;
+    case 't': m_token.push_back('\t'); break;
+
+    case 'u':
+        m_code_unit = 0;
+        m_count_hex = 0;
+        m_state = state_type::string_unicode;
+        break;
+
+    default:
+        throw stream_parse_error();
+    }
+}
+
+auto stream_parser::feed_unicode(char const letter) -> void
+{
+    m_code_unit = (m_code_unit << 4) | get_hex_value(letter);
+    if (++m_count_hex < 4)
+        return;
+
+    m_state = state_type::string;
+    if (m_code_unit >= 0xd800 && m_code_unit < 0xdc00)
+    {
+        // the low half follows as an escape of its own
+        if (m_surrogate_high != 0)
+            throw stream_parse_error();
+        m_surrogate_high = m_code_unit;
+        return;
+    }
+    if (m_code_unit >= 0xdc00 && m_code_unit < 0xe000)
+    {
+        if (m_surrogate_high == 0)
+            throw stream_parse_error();
+        append_utf8(m_token, 0x10000 + ((m_surrogate_high - 0xd800) << 10) + (m_code_unit - 0xdc00));
+        m_surrogate_high = 0;
+        return;
+    }
+    if (m_surrogate_high != 0)
+        throw stream_parse_error();
+    append_utf8(m_token, m_code_unit);
+}
+
+auto stream_parser::end_string(void) -> void
+{
+    m_surrogate_high = 0;
+    if (m_is_key)
+    {
+        m_handler.key(m_token);
+        m_token.clear();
+        m_state = state_type::colon;
+        return;
+    }
+
+    m_handler.string(m_token);
+    m_token.clear();
+    end_value();
+}
+
+auto stream_parser::end_number(void) -> void
+{
+    if (!is_number(m_token))
+        throw stream_parse_error();
+    m_handler.number(m_token);
+    m_token.clear();
+    end_value();
+}
+
+auto stream_parser::end_literal(void) -> void
+{
+    if (m_token == "null")
+        m_handler.null();
+    else if (m_token == "true")
+        m_handler.boolean(true);
+    else if (m_token == "false")
+        m_handler.boolean(false);
+    else
+        throw stream_parse_error();
+    m_token.clear();
+    end_value();
+}
+
+auto stream_parser::end_container(char const letter) -> void
+{
+    if (m_containers.empty() || m_containers.back() != (letter == '}' ? '{' : '['))
+        throw stream_parse_error();
+
+    m_containers.pop_back();
+    if (letter == '}')
+        m_handler.end_object();
+    else
+        m_handler.end_array();
+    end_value();
+}
+
+auto stream_parser::end_value(void) -> void
+{
+    m_is_container_empty = false;
+    m_state = m_containers.empty() ? state_type::done : state_type::comma;
+}
+
+} // namespace qyzk::ohno
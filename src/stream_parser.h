@@ -0,0 +1,85 @@
+#ifndef __QYZK_OHNO_STREAM_PARSER_H__
+#define __QYZK_OHNO_STREAM_PARSER_H__
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace qyzk::ohno
+{
+
+/*
+ * receives the parts of a json text as the stream_parser finds them
+ * views are only valid during the call, numbers are handed over as written
+ */
+class stream_handler
+{
+public:
+    virtual ~stream_handler(void) = default;
+
+    virtual auto null(void) -> void = 0;
+    virtual auto boolean(bool const value) -> void = 0;
+    virtual auto number(std::string_view const text) -> void = 0;
+    virtual auto string(std::string_view const value) -> void = 0;
+    virtual auto key(std::string_view const name) -> void = 0;
+    virtual auto start_object(void) -> void = 0;
+    virtual auto end_object(void) -> void = 0;
+    virtual auto start_array(void) -> void = 0;
+    virtual auto end_array(void) -> void = 0;
+}; // class qyzk::ohno::stream_handler
+
+/*
+ * push parser for one json text fed in pieces of any size, e.g. as they come off the socket
+ * only the token being read is kept between pieces, never the text itself
+ */
+class stream_parser
+{
+public:
+    explicit stream_parser(ohno::stream_handler& handler);
+
+    auto feed(std::string_view const text) -> void;
+    // throws unless exactly one complete json text has been fed
+    auto finish(void) -> void;
+    auto is_done(void) const noexcept -> bool;
+
+private:
+    enum class state_type
+    {
+        value,
+        key,
+        colon,
+        comma,
+        string,
+        string_escape,
+        string_unicode,
+        number,
+        literal,
+        done,
+    };
+
+    auto feed(char const letter) -> void;
+    auto feed_value(char const letter) -> void;
+    auto feed_comma(char const letter) -> void;
+    auto feed_escape(char const letter) -> void;
+    auto feed_unicode(char const letter) -> void;
+    auto end_string(void) -> void;
+    auto end_number(void) -> void;
+    auto end_literal(void) -> void;
+    auto end_container(char const letter) -> void;
+    auto end_value(void) -> void;
+
+    ohno::stream_handler& m_handler;
+    state_type m_state;
+    std::vector< char > m_containers;
+    bool m_is_container_empty;
+    bool m_is_key;
+    std::string m_token;
+    uint32_t m_code_unit;
+    uint32_t m_count_hex;
+    uint32_t m_surrogate_high;
+}; // class qyzk::ohno::stream_parser
+
+} // namespace qyzk::ohno
+
+#endif
@@ -0,0 +1,138 @@
+#include <exception>
+
+#include <boost/log/trivial.hpp>
+
+#include "./tls_session_cache.h"
+
+namespace
+{
+
+class tls_session_attach_error : public std::exception
+{
+public:
+    virtual auto what(void) const noexcept -> const char* override
+    {
+        return "failed to attach tls session cache to context";
+    }
+};
+
+// a slot of our own, asio keeps its verify callback in the context's app data and deletes it with the context
+auto get_index(void) -> int
+{
+    static int const index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+auto get_cache(SSL* const ssl) -> qyzk::ohno::tls_session_cache*
+{
+    return static_cast< qyzk::ohno::tls_session_cache* >(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), get_index()));
+}
+
+} // namespace
+
+namespace qyzk::ohno
+{
+
+tls_session_cache::tls_session_cache(void)
+    : m_mutex()
+    , m_sessions()
+    , m_count_full(0)
+    , m_count_resumed(0)
+{
+}
+
+tls_session_cache::~tls_session_cache(void)
+{
+    for (auto const& [hostname, session] : m_sessions)
+        SSL_SESSION_free(session);
+}
+
+auto tls_session_cache::attach(boost::asio::ssl::context& context) -> void
+{
+    auto* const handle = context.native_handle();
+    if (get_index() < 0 || SSL_CTX_set_ex_data(handle, get_index(), this) != 1)
+        throw tls_session_attach_error();
+
+    // openssl's own client cache is never looked up, sessions are offered by hostname in resume
+    SSL_CTX_set_session_cache_mode(handle, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(
+        handle,
+        [](SSL* ssl, SSL_SESSION* session) -> int
+        {
+            auto* const cache = get_cache(ssl);
+            auto const* const hostname = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+            if (cache == nullptr || hostname == nullptr)
+                return 0;
+
+            // taking over the reference openssl handed us
+            cache->store(hostname, session);
+            return 1;
+        });
+}
+
+auto tls_session_cache::get_statistics(void) const noexcept -> tls_session_statistics
+{
+    return {
+        m_count_full.load(),
+        m_count_resumed.load(),
+    };
+}
+
+auto tls_session_cache::resume(SSL* const ssl) -> void
+{
+    auto* const cache = get_cache(ssl);
+    auto const* const hostname = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+    if (cache == nullptr || hostname == nullptr)
+        return;
+
+    auto* const session = cache->load(hostname);
+    if (session == nullptr)
+        return;
+
+    SSL_set_session(ssl, session);
+    SSL_SESSION_free(session);
+}
+
+auto tls_session_cache::record(SSL* const ssl) -> void
+{
+    auto* const cache = get_cache(ssl);
+    if (cache == nullptr)
+        return;
+
+    auto const is_resumed = SSL_session_reused(ssl) == 1;
+    if (is_resumed)
+        ++cache->m_count_resumed;
+    else
+        ++cache->m_count_full;
+
+    auto const statistics = cache->get_statistics();
+    BOOST_LOG_TRIVIAL(debug)
+        << (is_resumed ? "resumed" : "full") << " tls handshake, "
+        << statistics.count_resumed << " resumed of " << (statistics.count_resumed + statistics.count_full);
+}
+
+auto tls_session_cache::store(
+    std::string const& hostname,
+    SSL_SESSION* const session)
+    -> void
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    auto& stored = m_sessions[hostname];
+    if (stored != nullptr)
+        SSL_SESSION_free(stored);
+    stored = session;
+}
+
+auto tls_session_cache::load(std::string const& hostname) -> SSL_SESSION*
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    auto const found = m_sessions.find(hostname);
+    if (found == m_sessions.end() || SSL_SESSION_is_resumable(found->second) != 1)
+        return nullptr;
+
+    // the caller's own reference, the stored one may be replaced any time
+    SSL_SESSION_up_ref(found->second);
+    return found->second;
+}
+
+} // namespace qyzk::ohno
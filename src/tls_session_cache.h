@@ -0,0 +1,58 @@
+#ifndef __QYZK_OHNO_TLS_SESSION_CACHE_H__
+#define __QYZK_OHNO_TLS_SESSION_CACHE_H__
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <boost/asio/ssl.hpp>
+
+namespace qyzk::ohno
+{
+
+struct tls_session_statistics
+{
+    uint64_t count_full;
+    uint64_t count_resumed; // handshakes that got away with an abbreviated one
+};
+
+/*
+ * client side tls sessions by hostname, shared by every connection made with the context it's attached to
+ * sessions come in through openssl's new session callback, tls 1.3 tickets only arrive after the handshake
+ * safe to call from any thread, the cache has to outlive the context
+ */
+class tls_session_cache
+{
+public:
+    tls_session_cache(void);
+    ~tls_session_cache(void);
+
+    tls_session_cache(tls_session_cache const&) = delete;
+    auto operator=(tls_session_cache const&) -> tls_session_cache& = delete;
+
+    auto attach(boost::asio::ssl::context& context) -> void;
+    auto get_statistics(void) const noexcept -> tls_session_statistics;
+
+    // before a connection's handshake, offers the session last seen for its sni hostname
+    static auto resume(SSL* const ssl) -> void;
+    // after a connection's handshake, counts whether the session was resumed
+    static auto record(SSL* const ssl) -> void;
+
+private:
+    auto store(
+        std::string const& hostname,
+        SSL_SESSION* const session)
+        -> void;
+    auto load(std::string const& hostname) -> SSL_SESSION*;
+
+    mutable std::mutex m_mutex;
+    std::map< std::string, SSL_SESSION* > m_sessions; // owned, freed on replacing
+    std::atomic< uint64_t > m_count_full;
+    std::atomic< uint64_t > m_count_resumed;
+}; // class qyzk::ohno::tls_session_cache
+
+} // namespace qyzk::ohno
+
+#endif
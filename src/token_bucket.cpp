@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <cmath>
+
+#include "./token_bucket.h"
+
+namespace qyzk::ohno
+{
+
+token_bucket::token_bucket(
+    uint32_t const capacity,
+    clock_type::duration const period_refill,
+    clock_type::time_point const now)
+    : m_capacity(capacity)
+    , m_rate_refill(static_cast< double >(capacity) / static_cast< double >(period_refill.count()))
+    , m_tokens(capacity)
+    , m_time_refill(now)
+{
+}
+
+auto token_bucket::try_take(
+    clock_type::time_point const now,
+    uint32_t const reserve)
+    -> bool
+{
+    refill(now);
+    if (m_tokens < 1.0 + reserve)
+        return false;
+
+    m_tokens -= 1.0;
+    return true;
+}
+
+auto token_bucket::get_wait(
+    clock_type::time_point const now,
+    uint32_t const reserve)
+    -> clock_type::duration
+{
+    refill(now);
+    auto const missing = 1.0 + reserve - m_tokens;
+    if (missing <= 0.0)
+        return clock_type::duration::zero();
+    return clock_type::duration(static_cast< clock_type::rep >(std::ceil(missing / m_rate_refill)));
+}
+
+auto token_bucket::refill(clock_type::time_point const now) -> void
+{
+    if (now <= m_time_refill)
+        return;
+
+    m_tokens = std::min(m_capacity, m_tokens + m_rate_refill * static_cast< double >((now - m_time_refill).count()));
+    m_time_refill = now;
+}
+
+} // namespace qyzk::ohno
@@ -0,0 +1,46 @@
+#ifndef __QYZK_OHNO_TOKEN_BUCKET_H__
+#define __QYZK_OHNO_TOKEN_BUCKET_H__
+
+#include <chrono>
+#include <cstdint>
+
+namespace qyzk::ohno
+{
+
+/*
+ * refills capacity tokens per period_refill continuously up to its capacity, a full bucket allows a burst of capacity tokens
+ * takers may leave a reserve untouched, so that some tokens are always left for whoever takes without one
+ * not synchronized, it belongs to whoever writes the connection
+ */
+class token_bucket
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    token_bucket(
+        uint32_t const capacity,
+        clock_type::duration const period_refill,
+        clock_type::time_point const now);
+
+    auto try_take(
+        clock_type::time_point const now,
+        uint32_t const reserve)
+        -> bool;
+    // how long until try_take with the same reserve succeeds
+    auto get_wait(
+        clock_type::time_point const now,
+        uint32_t const reserve)
+        -> clock_type::duration;
+
+private:
+    auto refill(clock_type::time_point const now) -> void;
+
+    double const m_capacity;
+    double const m_rate_refill; // tokens per tick of clock_type
+    double m_tokens;
+    clock_type::time_point m_time_refill;
+}; // class qyzk::ohno::token_bucket
+
+} // namespace qyzk::ohno
+
+#endif
@@ -0,0 +1,98 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include <zlib.h>
+
+#include "../src/inflater.h"
+
+namespace
+{
+
+auto count_failed = 0;
+
+auto check(
+    bool const condition,
+    std::string_view const name)
+    -> void
+{
+    if (condition)
+        return;
+
+    std::cerr << "failed: " << name << std::endl;
+    ++count_failed;
+}
+
+// one payload of a zlib stream the way the gateway sends it, ending with a sync flush
+class deflater
+{
+public:
+    deflater(void)
+        : m_stream()
+    {
+        deflateInit(&m_stream, Z_DEFAULT_COMPRESSION);
+    }
+
+    ~deflater(void)
+    {
+        deflateEnd(&m_stream);
+    }
+
+    auto deflate(std::string_view const text) -> std::string
+    {
+        std::string compressed(deflateBound(&m_stream, static_cast< uLong >(text.size())) + 64, '\0');
+        m_stream.next_in = reinterpret_cast< Bytef* >(const_cast< char* >(text.data()));
+        m_stream.avail_in = static_cast< uInt >(text.size());
+        m_stream.next_out = reinterpret_cast< Bytef* >(compressed.data());
+        m_stream.avail_out = static_cast< uInt >(compressed.size());
+        ::deflate(&m_stream, Z_SYNC_FLUSH);
+        compressed.resize(compressed.size() - m_stream.avail_out);
+        return compressed;
+    }
+
+private:
+    z_stream m_stream;
+};
+
+auto get_text(boost::beast::flat_buffer const& buffer) -> std::string
+{
+    return { static_cast< char const* >(buffer.data().data()), buffer.size() };
+}
+
+} // namespace
+
+auto main(void) -> int
+{
+    std::string const first = R"({"op":0,"t":"GUILD_CREATE","d":{"members":[]}})";
+    std::string const second = R"({"op":11,"d":null})";
+
+    // every split of a payload, including ones inside the suffix, is only complete after its last piece
+    deflater compressor;
+    qyzk::ohno::inflater decompressor;
+    auto const compressed_first = compressor.deflate(first);
+    for (std::size_t position = 1; position < compressed_first.size(); ++position)
+    {
+        qyzk::ohno::inflater decompressor_split;
+        boost::beast::flat_buffer output;
+        check(!decompressor_split.feed(std::string_view(compressed_first).substr(0, position), output), "split payload, first piece");
+        check(decompressor_split.feed(std::string_view(compressed_first).substr(position), output), "split payload, last piece");
+        check(get_text(output) == first, "split payload, text");
+    }
+
+    // the suffix split into pieces shorter than itself, after a payload that was complete
+    boost::beast::flat_buffer output;
+    check(decompressor.feed(compressed_first, output), "whole payload");
+    check(get_text(output) == first, "whole payload, text");
+
+    output.clear();
+    auto const compressed_second = compressor.deflate(second);
+    auto const size_body = compressed_second.size() - 4;
+    check(!decompressor.feed(std::string_view(compressed_second).substr(0, size_body), output), "suffix split, body");
+    check(!decompressor.feed(std::string_view(compressed_second).substr(size_body, 1), output), "suffix split, one byte");
+    check(!decompressor.feed(std::string_view(compressed_second).substr(size_body + 1, 2), output), "suffix split, two bytes");
+    check(decompressor.feed(std::string_view(compressed_second).substr(size_body + 3), output), "suffix split, last byte");
+    check(get_text(output) == second, "suffix split, text");
+
+    return count_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
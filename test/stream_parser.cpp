@@ -0,0 +1,122 @@
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "../src/stream_parser.h"
+
+namespace
+{
+
+// every call written down in order, so that two parses can be compared as strings
+class recording_handler : public qyzk::ohno::stream_handler
+{
+public:
+    std::string record;
+
+    auto null(void) -> void override { record += "null "; }
+    auto boolean(bool const value) -> void override { record += value ? "true " : "false "; }
+    auto number(std::string_view const text) -> void override { record += "number:" + std::string(text) + " "; }
+    auto string(std::string_view const value) -> void override { record += "string:" + std::string(value) + " "; }
+    auto key(std::string_view const name) -> void override { record += "key:" + std::string(name) + " "; }
+    auto start_object(void) -> void override { record += "{ "; }
+    auto end_object(void) -> void override { record += "} "; }
+    auto start_array(void) -> void override { record += "[ "; }
+    auto end_array(void) -> void override { record += "] "; }
+};
+
+auto count_failed = 0;
+
+auto check(
+    bool const condition,
+    std::string_view const name)
+    -> void
+{
+    if (condition)
+        return;
+
+    std::cerr << "failed: " << name << std::endl;
+    ++count_failed;
+}
+
+// the record of parsing text in two pieces split at position, empty if parsing threw
+auto parse_split(
+    std::string_view const text,
+    std::size_t const position)
+    -> std::string
+{
+    recording_handler handler;
+    qyzk::ohno::stream_parser parser(handler);
+    try
+    {
+        parser.feed(text.substr(0, position));
+        parser.feed(text.substr(position));
+        parser.finish();
+    }
+    catch (std::exception const&)
+    {
+        return {};
+    }
+    return handler.record;
+}
+
+// every split of text has to give the expected record
+auto check_parses(
+    std::string_view const text,
+    std::string_view const expected)
+    -> void
+{
+    for (std::size_t position = 0; position <= text.size(); ++position)
+        check(parse_split(text, position) == expected, text);
+}
+
+auto check_rejects(std::string_view const text) -> void
+{
+    for (std::size_t position = 0; position <= text.size(); ++position)
+        check(parse_split(text, position).empty(), text);
+}
+
+} // namespace
+
+auto main(void) -> int
+{
+    check_parses(
+        R"({"op":0,"d":{"a":[true,false,null],"b":-12.5e+3}})",
+        "{ key:op number:0 key:d { key:a [ true false null ] key:b number:-12.5e+3 } } ");
+    check_parses(R"(["a\"b\\c\nA"])", "[ string:a\"b\\c\nA ] ");
+    check_parses(R"(["é€😀"])", "[ string:\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80 ] ");
+    check_parses("  [ ]  ", "[ ] ");
+    check_parses("{}", "{ } ");
+    check_parses("0", "number:0 ");
+    check_parses("[0.5,-0,1E9]", "[ number:0.5 number:-0 number:1E9 ] ");
+
+    // unpaired surrogates, also when the low half turns up in another string
+    check_rejects(R"(["\ud83d"])");
+    check_rejects(R"(["\ud83dx"])");
+    check_rejects(R"(["\ud83d\n"])");
+    check_rejects(R"(["\ud83dA"])");
+    check_rejects(R"(["\ud83d\ud83d"])");
+    check_rejects(R"(["\ud83d","\ude00"])");
+    check_rejects(R"(["\ude00"])");
+    check_rejects(R"(["\u00g1"])");
+
+    check_rejects("[+1]");
+    check_rejects("[-]");
+    check_rejects("[1e]");
+    check_rejects("[..]");
+    check_rejects("[1.]");
+    check_rejects("[.5]");
+    check_rejects("[01]");
+    check_rejects("[1e+]");
+    check_rejects("1-");
+
+    check_rejects("[nul]");
+    check_rejects("[truex]");
+    check_rejects("[1,]");
+    check_rejects(R"({"a" 1})");
+    check_rejects("[1] 2");
+    check_rejects("[1");
+
+    return count_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}